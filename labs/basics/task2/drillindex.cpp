@@ -0,0 +1,300 @@
+// NOLINTBEGIN(readability-identifier-naming)
+#include "drillindex.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+constexpr char kMagic[4] = {'O', 'D', 'R', 'L'};
+constexpr uint32_t kVersion = 1;
+// A drill is made of everyday words; rarer ones only make the index bigger.
+constexpr qsizetype kMaxWords = 50'000;
+constexpr qsizetype kMaxWordLength = 24;
+
+// The cache is only ever read on the machine that wrote it, so it is in native byte order.
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t wordCount;
+    uint32_t bigramCount;
+    uint32_t postingCount;
+    uint32_t charCount;
+};
+
+// True if `offsets[0..count]` split [0, end) into `count` non-empty ranges in order.
+bool isPartition(const uint32_t* offsets, uint32_t count, uint32_t end) {
+    if (offsets[0] != 0 || offsets[count] != end) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        if (offsets[i + 1] <= offsets[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t bigramKey(QChar first, QChar second) {
+    return (static_cast<uint32_t>(first.unicode()) << 16) | second.unicode();
+}
+
+void append(QByteArray& out, const std::vector<uint32_t>& values) {
+    out.append(
+        reinterpret_cast<const char*>(values.data()),
+        static_cast<qsizetype>(values.size() * sizeof(uint32_t)));
+}
+
+QByteArray buildIndex(QStringView corpus) {
+    QHash<QString, uint32_t> counts;
+    QString word;
+    const auto countWord = [&] {
+        if (!word.isEmpty() && word.size() <= kMaxWordLength) {
+            ++counts[word];
+        }
+        word.truncate(0);
+    };
+    for (const QChar character : corpus) {
+        if (character.isLetter()) {
+            word.append(character.toLower());
+        } else {
+            countWord();
+        }
+    }
+    countWord();
+
+    std::vector<std::pair<QString, uint32_t>> words;
+    words.reserve(counts.size());
+    for (auto it = counts.cbegin(); it != counts.cend(); ++it) {
+        words.emplace_back(it.key(), it.value());
+    }
+    counts.clear();
+    // Most frequent first, so that posting lists are too; ties by word, so the cache does not
+    // depend on the hash order.
+    const auto middle = words.begin() + std::min<qsizetype>(std::ssize(words), kMaxWords);
+    std::partial_sort(words.begin(), middle, words.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    words.erase(middle, words.end());
+
+    std::vector<uint32_t> wordOffsets{0};
+    QString chars;
+    std::vector<std::pair<uint32_t, uint32_t>> postings;
+    std::vector<uint32_t> wordBigrams;
+    for (uint32_t id = 0; id < words.size(); ++id) {
+        const QString& text = words[id].first;
+        chars.append(text);
+        wordOffsets.push_back(static_cast<uint32_t>(chars.size()));
+        wordBigrams.clear();
+        for (qsizetype i = 0; i <= text.size(); ++i) {
+            wordBigrams.push_back(bigramKey(
+                i == 0 ? QChar(' ') : text[i - 1], i == text.size() ? QChar(' ') : text[i]));
+        }
+        std::sort(wordBigrams.begin(), wordBigrams.end());
+        wordBigrams.erase(
+            std::unique(wordBigrams.begin(), wordBigrams.end()), wordBigrams.end());
+        for (const uint32_t key : wordBigrams) {
+            postings.emplace_back(key, id);
+        }
+    }
+    std::sort(postings.begin(), postings.end());
+
+    std::vector<uint32_t> bigramKeys;
+    std::vector<uint32_t> postingStarts;
+    std::vector<uint32_t> postingWords;
+    std::vector<uint32_t> postingWeights;
+    postingWords.reserve(postings.size());
+    postingWeights.reserve(postings.size());
+    for (const auto& [key, id] : postings) {
+        uint32_t weight = words[id].second;
+        if (bigramKeys.empty() || bigramKeys.back() != key) {
+            bigramKeys.push_back(key);
+            postingStarts.push_back(static_cast<uint32_t>(postingWords.size()));
+        } else {
+            weight += postingWeights.back();
+        }
+        postingWords.push_back(id);
+        postingWeights.push_back(weight);
+    }
+    postingStarts.push_back(static_cast<uint32_t>(postingWords.size()));
+
+    const Header header{
+        {kMagic[0], kMagic[1], kMagic[2], kMagic[3]},
+        kVersion,
+        static_cast<uint32_t>(words.size()),
+        static_cast<uint32_t>(bigramKeys.size()),
+        static_cast<uint32_t>(postingWords.size()),
+        static_cast<uint32_t>(chars.size()),
+    };
+    QByteArray index(reinterpret_cast<const char*>(&header), sizeof(header));
+    append(index, wordOffsets);
+    append(index, bigramKeys);
+    append(index, postingStarts);
+    append(index, postingWords);
+    append(index, postingWeights);
+    index.append(
+        reinterpret_cast<const char*>(chars.constData()), chars.size() * qsizetype{2});
+    return index;
+}
+}  // namespace
+
+void DrillIndex::open(const QString& cacheFile, QStringView corpus) {
+    file.setFileName(cacheFile);
+    if (file.open(QFile::ReadOnly)) {
+        const uchar* data = file.map(0, file.size());
+        if (data != nullptr && map(data, file.size())) {
+            return;
+        }
+        file.close();
+    }
+
+    built = buildIndex(corpus);
+    QDir().mkpath(QFileInfo(cacheFile).absolutePath());
+    QSaveFile cache(cacheFile);
+    if (cache.open(QFile::WriteOnly) && cache.write(built) == built.size() && cache.commit() &&
+        file.open(QFile::ReadOnly)) {
+        const uchar* data = file.map(0, file.size());
+        if (data != nullptr && map(data, file.size())) {
+            built.clear();
+            return;
+        }
+        file.close();
+    }
+    map(reinterpret_cast<const uchar*>(built.constData()), built.size());
+}
+
+QString DrillIndex::cacheFileFor(const QString& corpusFile) {
+    const QFileInfo info(corpusFile);
+    const QString identity = QString("%1|%2|%3")
+                                 .arg(info.absoluteFilePath())
+                                 .arg(info.size())
+                                 .arg(info.lastModified().toMSecsSinceEpoch());
+    const QByteArray hash =
+        QCryptographicHash::hash(identity.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/drills/" +
+           QString::fromLatin1(hash) + ".idx";
+}
+
+bool DrillIndex::isEmpty() const {
+    return wordCount == 0;
+}
+
+int DrillIndex::size() const {
+    return static_cast<int>(wordCount);
+}
+
+QStringView DrillIndex::word(int index) const {
+    return {chars + wordOffsets[index], chars + wordOffsets[index + 1]};
+}
+
+QString DrillIndex::generate(
+    const std::vector<Bigram>& bigrams, int words, QRandomGenerator& random) const {
+    // Only the bigrams of the corpus can be practiced; each keeps its posting list and the running
+    // sum of the weights up to it.
+    struct Target {
+        uint32_t begin;
+        uint32_t end;
+        double weight;
+    };
+    std::vector<Target> targets;
+    double totalWeight = 0;
+    for (const Bigram& bigram : bigrams) {
+        const uint32_t key = bigramKey(bigram.first, bigram.second);
+        const uint32_t* found = std::lower_bound(bigramKeys, bigramKeys + bigramCount, key);
+        if (found == bigramKeys + bigramCount || *found != key || bigram.weight <= 0) {
+            continue;
+        }
+        const auto index = found - bigramKeys;
+        totalWeight += bigram.weight;
+        targets.push_back({postingStarts[index], postingStarts[index + 1], totalWeight});
+    }
+    if (targets.empty()) {
+        return {};
+    }
+
+    QString drill;
+    drill.reserve(static_cast<qsizetype>(words) * 8);
+    for (int i = 0; i < words; ++i) {
+        const double pick = random.generateDouble() * totalWeight;
+        auto target = std::upper_bound(
+            targets.cbegin(), targets.cend(), pick,
+            [](double value, const Target& target) { return value < target.weight; });
+        target = std::min(target, targets.cend() - 1);
+        const uint32_t frequency = random.bounded(postingWeights[target->end - 1]);
+        const uint32_t* posting = std::upper_bound(
+            postingWeights + target->begin, postingWeights + target->end, frequency);
+        if (i > 0) {
+            drill.append(QLatin1Char(' '));
+        }
+        drill.append(word(static_cast<int>(postingWords[posting - postingWeights])));
+    }
+    return drill;
+}
+
+bool DrillIndex::map(const uchar* data, qint64 size) {
+    Header header{};
+    if (size < static_cast<qint64>(sizeof(header))) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    // In 64 bits, so that no count can wrap around and make a short file look complete.
+    const qint64 expected =
+        static_cast<qint64>(sizeof(header)) +
+        (static_cast<qint64>(sizeof(uint32_t)) *
+         ((qint64{header.wordCount} + 1) + (2 * qint64{header.bigramCount}) + 1 +
+          (2 * qint64{header.postingCount}))) +
+        (static_cast<qint64>(sizeof(char16_t)) * header.charCount);
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        size != expected) {
+        return false;
+    }
+    // Every section is a whole number of 32-bit values and both a mapping and QByteArray data are
+    // at least 8-byte aligned, so the sections can be read in place.
+    const auto* values = reinterpret_cast<const uint32_t*>(data + sizeof(header));
+    const uint32_t* const offsets = values;
+    const uint32_t* const keys = offsets + header.wordCount + 1;
+    const uint32_t* const starts = keys + header.bigramCount;
+    const uint32_t* const postings = starts + header.bigramCount + 1;
+    const uint32_t* const weights = postings + header.postingCount;
+
+    // word() and generate() index with these values unchecked, so a cache that was damaged on disk
+    // must not get past here. This reads the whole file once, which is still far cheaper than
+    // rebuilding the index.
+    if (!isPartition(offsets, header.wordCount, header.charCount) ||
+        !isPartition(starts, header.bigramCount, header.postingCount)) {
+        return false;
+    }
+    for (uint32_t bigram = 0; bigram < header.bigramCount; ++bigram) {
+        if (bigram > 0 && keys[bigram] <= keys[bigram - 1]) {
+            return false;
+        }
+        // Running sums of frequencies, so each list starts above 0 and only grows.
+        uint32_t previousWeight = 0;
+        for (uint32_t posting = starts[bigram]; posting < starts[bigram + 1]; ++posting) {
+            if (postings[posting] >= header.wordCount || weights[posting] <= previousWeight) {
+                return false;
+            }
+            previousWeight = weights[posting];
+        }
+    }
+
+    wordOffsets = offsets;
+    bigramKeys = keys;
+    postingStarts = starts;
+    postingWords = postings;
+    postingWeights = weights;
+    chars = reinterpret_cast<const char16_t*>(weights + header.postingCount);
+    wordCount = header.wordCount;
+    bigramCount = header.bigramCount;
+    return true;
+}
+
+// NOLINTEND(readability-identifier-naming)
@@ -0,0 +1,64 @@
+#ifndef DRILLINDEX_H
+#define DRILLINDEX_H
+
+#include <QByteArray>
+#include <QChar>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QString>
+#include <QStringView>
+#include <cstdint>
+#include <vector>
+
+// The most frequent words of a training corpus, indexed by the character bigrams they contain, for
+// generating drills that practice particular bigrams.
+//
+// Building the index reads the whole corpus once; the result is written to a cache file that is
+// memory-mapped on the next load of the same corpus, so reopening a large corpus costs nothing.
+// Words are lowercased, and every word is padded with a space on both sides, so a bigram with a
+// space matches the words that start or end with its other character.
+class DrillIndex {
+   public:
+    struct Bigram {
+        QChar first;
+        QChar second;
+        // Relative share of the drill words picked for this bigram.
+        double weight;
+    };
+
+    // Maps `cacheFile`, or builds the index from `corpus` and writes it there first. If the cache
+    // cannot be written the index is kept in memory. Safe to call from any thread.
+    void open(const QString& cacheFile, QStringView corpus);
+    // Cache file for the corpus loaded from `corpusFile`; changes when the file does.
+    static QString cacheFileFor(const QString& corpusFile);
+
+    [[nodiscard]] bool isEmpty() const;
+    // Number of indexed words, and word `index` of them; the most frequent word is word 0.
+    [[nodiscard]] int size() const;
+    [[nodiscard]] QStringView word(int index) const;
+    // `words` space-separated words, each containing one of `bigrams`. A bigram is picked in
+    // proportion to its weight, then a word containing it in proportion to its corpus frequency.
+    // Empty if the corpus has none of the bigrams. The same `random` state gives the same drill.
+    [[nodiscard]] QString generate(
+        const std::vector<Bigram>& bigrams, int words, QRandomGenerator& random) const;
+
+   private:
+    bool map(const uchar* data, qint64 size);
+
+    QFile file;
+    QByteArray built;
+    uint32_t wordCount = 0;
+    uint32_t bigramCount = 0;
+    // Characters of word i are chars[wordOffsets[i], wordOffsets[i + 1]).
+    const uint32_t* wordOffsets = nullptr;
+    // Sorted bigram keys; the words of bigram i are postings [postingStarts[i],
+    // postingStarts[i + 1]), most frequent first.
+    const uint32_t* bigramKeys = nullptr;
+    const uint32_t* postingStarts = nullptr;
+    const uint32_t* postingWords = nullptr;
+    // Running sum of the word frequencies within each posting list.
+    const uint32_t* postingWeights = nullptr;
+    const char16_t* chars = nullptr;
+};
+
+#endif  // DRILLINDEX_H
@@ -0,0 +1,172 @@
+// NOLINTBEGIN(readability-identifier-naming)
+#include "drillindex.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+const QString kCorpus =
+    "The cat sat on the mat. The dog and the cat ran;\nA bat flew over the dam, dad!";
+
+QStringList words(const DrillIndex& index) {
+    QStringList result;
+    for (int i = 0; i < index.size(); ++i) {
+        result.append(index.word(i).toString());
+    }
+    return result;
+}
+
+QByteArray readFile(const QString& fileName) {
+    QFile file(fileName);
+    return file.open(QFile::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+void writeFile(const QString& fileName, const QByteArray& contents) {
+    QFile file(fileName);
+    REQUIRE(file.open(QFile::WriteOnly | QFile::Truncate));
+    REQUIRE(file.write(contents) == contents.size());
+}
+
+// Opens `cacheFile`, which is expected to be rejected, and checks that it was rebuilt into `valid`.
+void checkRebuilt(const QString& cacheFile, const QByteArray& valid) {
+    DrillIndex index;
+    index.open(cacheFile, kCorpus);
+    CHECK(index.size() == 14);
+    CHECK(readFile(cacheFile) == valid);
+}
+}  // namespace
+
+TEST_CASE("A mapped cache holds the same index as a freshly built one") {
+    const QTemporaryDir dir;
+    writeFile(dir.filePath("file"), "not a directory");
+    DrillIndex built;
+    // The cache cannot be written under a regular file, so this index stays in memory.
+    built.open(dir.filePath("file/drill.idx"), kCorpus);
+
+    const QString cacheFile = dir.filePath("cache/drill.idx");
+    DrillIndex written;
+    written.open(cacheFile, kCorpus);
+    REQUIRE(QFile::exists(cacheFile));
+    // Another corpus would give another index; the cache wins.
+    DrillIndex mapped;
+    mapped.open(cacheFile, QString());
+
+    const QStringList expected = words(built);
+    REQUIRE(expected.size() == 14);
+    // Most frequent first, ties in word order, everything lowercase.
+    CHECK(expected.mid(0, 3) == QStringList{"the", "cat", "a"});
+    CHECK(words(written) == expected);
+    CHECK(words(mapped) == expected);
+}
+
+TEST_CASE("A truncated or foreign cache is rebuilt") {
+    const QTemporaryDir dir;
+    const QString cacheFile = dir.filePath("drill.idx");
+    {
+        DrillIndex index;
+        index.open(cacheFile, kCorpus);
+    }
+    const QByteArray valid = readFile(cacheFile);
+    REQUIRE(valid.size() > 24);
+
+    writeFile(cacheFile, valid.left(valid.size() - 2));
+    checkRebuilt(cacheFile, valid);
+
+    writeFile(cacheFile, valid.left(10));
+    checkRebuilt(cacheFile, valid);
+
+    QByteArray otherVersion = valid;
+    const uint32_t version = 2;
+    std::memcpy(otherVersion.data() + 4, &version, sizeof(version));
+    writeFile(cacheFile, otherVersion);
+    checkRebuilt(cacheFile, valid);
+
+    QByteArray otherMagic = valid;
+    otherMagic[0] = 'X';
+    writeFile(cacheFile, otherMagic);
+    checkRebuilt(cacheFile, valid);
+}
+
+TEST_CASE("A cache with offsets or word ids out of range is rebuilt") {
+    const QTemporaryDir dir;
+    const QString cacheFile = dir.filePath("drill.idx");
+    {
+        DrillIndex index;
+        index.open(cacheFile, kCorpus);
+    }
+    const QByteArray valid = readFile(cacheFile);
+    REQUIRE(valid.size() > 24);
+    uint32_t wordCount = 0;
+    uint32_t bigramCount = 0;
+    std::memcpy(&wordCount, valid.constData() + 8, sizeof(wordCount));
+    std::memcpy(&bigramCount, valid.constData() + 12, sizeof(bigramCount));
+    const auto put = [&](qsizetype offset, uint32_t value) {
+        QByteArray corrupted = valid;
+        std::memcpy(corrupted.data() + offset, &value, sizeof(value));
+        return corrupted;
+    };
+    // Sections after the 24-byte header: word offsets, bigram keys, posting starts, posting words.
+    const qsizetype wordOffsets = 24;
+    const qsizetype postingStarts = wordOffsets + (4 * (wordCount + 1 + bigramCount));
+    const qsizetype postingWords = postingStarts + (4 * (bigramCount + 1));
+
+    // A word that would end past the characters, and one that would end before it starts.
+    writeFile(cacheFile, put(wordOffsets + 4, 1'000'000));
+    checkRebuilt(cacheFile, valid);
+    writeFile(cacheFile, put(wordOffsets + 8, 0));
+    checkRebuilt(cacheFile, valid);
+
+    writeFile(cacheFile, put(postingStarts + 4, 0));
+    checkRebuilt(cacheFile, valid);
+
+    writeFile(cacheFile, put(postingWords, wordCount));
+    checkRebuilt(cacheFile, valid);
+}
+
+TEST_CASE("Drills only contain words with the requested bigrams") {
+    const QTemporaryDir dir;
+    DrillIndex index;
+    index.open(dir.filePath("drill.idx"), kCorpus);
+    QRandomGenerator random(1);
+
+    const QStringList at = index.generate({{'a', 't', 1.0}}, 200, random).split(' ');
+    REQUIRE(at.size() == 200);
+    for (const QString& word : at) {
+        CHECK(word.contains("at"));
+    }
+
+    // A space stands for the start or the end of a word.
+    const QStringList mixed =
+        index.generate({{' ', 'd', 1.0}, {'n', ' ', 3.0}}, 200, random).split(' ');
+    REQUIRE(mixed.size() == 200);
+    for (const QString& word : mixed) {
+        CHECK((word.startsWith('d') || word.endsWith('n')));
+    }
+
+    CHECK(index.generate({{'z', 'q', 1.0}}, 10, random).isEmpty());
+    CHECK(index.generate({{'a', 't', 0.0}}, 10, random).isEmpty());
+}
+
+TEST_CASE("The same seed gives the same drill") {
+    const QTemporaryDir dir;
+    DrillIndex index;
+    index.open(dir.filePath("drill.idx"), kCorpus);
+    const std::vector<DrillIndex::Bigram> bigrams = {{'a', 't', 1.0}, {' ', 'd', 2.0}};
+
+    QRandomGenerator first(7);
+    QRandomGenerator second(7);
+    const QString drill = index.generate(bigrams, 100, first);
+    CHECK(index.generate(bigrams, 100, second) == drill);
+    // The generator moved on, so the next drill is another one.
+    CHECK(index.generate(bigrams, 100, first) != drill);
+}
+
+// NOLINTEND(readability-identifier-naming)
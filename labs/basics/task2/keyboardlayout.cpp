@@ -0,0 +1,193 @@
+// NOLINTBEGIN(readability-identifier-naming)
+#include "keyboardlayout.h"
+
+#include <array>
+#include <string_view>
+
+namespace keyboardlayout {
+namespace {
+constexpr int kRows = 5;
+constexpr int kKeyWidth = 50;
+constexpr int kKeyHeight = 50;
+constexpr int kKeySpacing = 5;
+constexpr int kHorizontalPadding = 20;
+constexpr int kVerticalPadding = 10;
+
+struct RowShape {
+    int keys;
+    int xOffset;
+    int keyWidth;
+};
+
+constexpr std::array<RowShape, kRows> kRowShapes = {{
+    {10, kKeyWidth, kKeyWidth},
+    {12, 0, kKeyWidth},
+    {11, kKeyWidth / 2, kKeyWidth},
+    {10, kKeyWidth, kKeyWidth},
+    {1, kKeyWidth * 4, kKeyWidth * 5},
+}};
+
+using Rows = std::array<std::u16string_view, kRows>;
+
+struct LayoutData {
+    const char* name;
+    Rows legends;
+    // Characters typed with Shift; looked up, but not drawn.
+    Rows shiftLegends;
+};
+
+// One entry per Layout, in the same order. The first layout also names the keys.
+constexpr std::array<LayoutData, kLayoutCount> kLayouts = {{
+    {"English",
+     {u"1234567890", u"QWERTYUIOP[]", u"ASDFGHJKL;'", u"ZXCVBNM,./", u" "},
+     {u"!@#$%^&*()", u"QWERTYUIOP{}", u"ASDFGHJKL:\"", u"ZXCVBNM<>?", u" "}},
+    {"Russian",
+     {u"1234567890", u"ЙЦУКЕНГШЩЗХЪ", u"ФЫВАПРОЛДЖЭ", u"ЯЧСМИТЬБЮ.", u" "},
+     {u"!\"№;%:?*()", u"ЙЦУКЕНГШЩЗХЪ", u"ФЫВАПРОЛДЖЭ", u"ЯЧСМИТЬБЮ,", u" "}},
+    {"Dvorak",
+     {u"1234567890", u"',.PYFGCRL/=", u"AOEUIDHTNS-", u";QJKXBMWVZ", u" "},
+     {u"!@#$%^&*()", u"\"<>PYFGCRL?+", u"AOEUIDHTNS_", u":QJKXBMWVZ", u" "}},
+    {"Colemak",
+     {u"1234567890", u"QWFPGJLUY;[]", u"ARSTDHNEIO'", u"ZXCVBKM,./", u" "},
+     {u"!@#$%^&*()", u"QWFPGJLUY:{}", u"ARSTDHNEIO\"", u"ZXCVBKM<>?", u" "}},
+    {"German",
+     {u"1234567890", u"QWERTZUIOPÜ+", u"ASDFGHJKLÖÄ", u"YXCVBNM,.-", u" "},
+     {u"!\"§$%&/()=", u"QWERTZUIOPÜ*", u"ASDFGHJKLÖÄ", u"YXCVBNM;:_", u" "}},
+}};
+
+constexpr bool rowsMatchShapes(const Rows& rows) {
+    for (int row = 0; row < kRows; ++row) {
+        if (static_cast<int>(rows[row].size()) != kRowShapes[row].keys) {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr bool layoutsMatchShapes() {
+    int keys = 0;
+    for (const RowShape& shape : kRowShapes) {
+        keys += shape.keys;
+    }
+    if (keys != kKeyCount) {
+        return false;
+    }
+    for (const LayoutData& layout : kLayouts) {
+        if (!rowsMatchShapes(layout.legends) || !rowsMatchShapes(layout.shiftLegends)) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(layoutsMatchShapes(), "every legend row needs one character per key of the row");
+
+// Calls `visit(index, row, column)` for every key in index order.
+template <typename Visit>
+constexpr void forEachKey(Visit visit) {
+    int index = 0;
+    for (int row = 0; row < kRows; ++row) {
+        for (int column = 0; column < kRowShapes[row].keys; ++column) {
+            visit(index++, row, column);
+        }
+    }
+}
+
+constexpr std::array<QRect, kKeyCount> kKeyRects = [] {
+    std::array<QRect, kKeyCount> rects{};
+    forEachKey([&](int index, int row, int column) {
+        const RowShape& shape = kRowShapes[row];
+        rects[index] = QRect(
+            kHorizontalPadding + shape.xOffset + (column * (shape.keyWidth + kKeySpacing)),
+            kVerticalPadding + (row * (kKeyHeight + kKeySpacing)), shape.keyWidth, kKeyHeight);
+    });
+    return rects;
+}();
+
+// Every US QWERTY legend is ASCII, and the Qt::Key of an ASCII key is its character code.
+constexpr std::array<Qt::Key, kKeyCount> kKeyCodes = [] {
+    std::array<Qt::Key, kKeyCount> codes{};
+    forEachKey([&](int index, int row, int column) {
+        codes[index] = static_cast<Qt::Key>(kLayouts[0].legends[row][column]);
+    });
+    return codes;
+}();
+
+constexpr int kKeyCodeLimit = 0x80;
+
+constexpr std::array<int8_t, kKeyCodeLimit> kKeyIndices = [] {
+    std::array<int8_t, kKeyCodeLimit> indices{};
+    indices.fill(-1);
+    for (int index = 0; index < kKeyCount; ++index) {
+        indices[kKeyCodes[index]] = static_cast<int8_t>(index);
+    }
+    return indices;
+}();
+
+using Legends = std::array<char16_t, kKeyCount>;
+
+constexpr std::array<Legends, kLayoutCount> kKeyLegends = [] {
+    std::array<Legends, kLayoutCount> legends{};
+    for (int layout = 0; layout < kLayoutCount; ++layout) {
+        forEachKey([&](int index, int row, int column) {
+            legends[layout][index] = kLayouts[layout].legends[row][column];
+        });
+    }
+    return legends;
+}();
+
+// Basic Latin up to Cyrillic, which covers every legend of the layouts above except '№'.
+// Characters past the end have no key.
+constexpr int kCharLimit = 0x500;
+
+using CharKeys = std::array<int8_t, kCharLimit>;
+
+constexpr std::array<CharKeys, kLayoutCount> kCharKeys = [] {
+    std::array<CharKeys, kLayoutCount> charKeys{};
+    for (int layout = 0; layout < kLayoutCount; ++layout) {
+        CharKeys& keys = charKeys[layout];
+        keys.fill(-1);
+        // Unshifted characters go last, so they win when a layout has a character on two keys.
+        for (const Rows* rows : {&kLayouts[layout].shiftLegends, &kLayouts[layout].legends}) {
+            forEachKey([&](int index, int row, int column) {
+                const char16_t character = (*rows)[row][column];
+                if (character < kCharLimit) {
+                    keys[character] = static_cast<int8_t>(index);
+                }
+            });
+        }
+    }
+    return charKeys;
+}();
+}  // namespace
+
+QString layoutName(Layout layout) {
+    return QString::fromLatin1(kLayouts[static_cast<int>(layout)].name);
+}
+
+int keyIndex(Qt::Key key) {
+    return key >= 0 && key < kKeyCodeLimit ? kKeyIndices[key] : -1;
+}
+
+Qt::Key keyCode(int index) {
+    return kKeyCodes[index];
+}
+
+QRect keyRect(int index) {
+    return kKeyRects[index];
+}
+
+QChar keyLegend(Layout layout, int index) {
+    return kKeyLegends[static_cast<int>(layout)][index];
+}
+
+Qt::Key keyForChar(Layout layout, QChar character) {
+    const char16_t upper = character.toUpper().unicode();
+    if (upper >= kCharLimit) {
+        return Qt::Key_unknown;
+    }
+    const int index = kCharKeys[static_cast<int>(layout)][upper];
+    return index < 0 ? Qt::Key_unknown : kKeyCodes[index];
+}
+}  // namespace keyboardlayout
+
+// NOLINTEND(readability-identifier-naming)
@@ -0,0 +1,33 @@
+#ifndef KEYBOARDLAYOUT_H
+#define KEYBOARDLAYOUT_H
+
+#include <QChar>
+#include <QRect>
+#include <QString>
+#include <Qt>
+#include <cstdint>
+
+// The physical keys of the on-screen keyboard and the characters every layout puts on them.
+//
+// All tables are generated at compile time from one legend string per keyboard row, so a new
+// layout is a new entry in the data, and every lookup is a single array access. Keys are numbered
+// row by row from the top left; the space bar is the last key. A key is identified by the Qt::Key
+// of its US QWERTY legend, whatever the layout.
+namespace keyboardlayout {
+enum class Layout : int8_t { English, Russian, Dvorak, Colemak, German };
+inline constexpr int kLayoutCount = 5;
+inline constexpr int kKeyCount = 44;
+
+[[nodiscard]] QString layoutName(Layout layout);
+// Index of the key with code `key`, -1 if the keyboard has no such key.
+[[nodiscard]] int keyIndex(Qt::Key key);
+[[nodiscard]] Qt::Key keyCode(int index);
+[[nodiscard]] QRect keyRect(int index);
+// Character printed on key `index` in `layout`.
+[[nodiscard]] QChar keyLegend(Layout layout, int index);
+// Key that types `character` in `layout`, with or without Shift; case is ignored.
+// Qt::Key_unknown if no key does.
+[[nodiscard]] Qt::Key keyForChar(Layout layout, QChar character);
+}  // namespace keyboardlayout
+
+#endif  // KEYBOARDLAYOUT_H
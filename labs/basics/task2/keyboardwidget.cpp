@@ -1,7 +1,20 @@
 #include "keyboardwidget.h"
 
 #include <QFontMetrics>
+#include <QPaintEvent>
 #include <QPainter>
+#include <QPixmapCache>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const QColor kKeyColor(200, 200, 200);
+const QColor kActiveKeyColor(173, 216, 230);
+const QColor kHotKeyColor(231, 76, 60);
+constexpr int kHeatLevels = 16;
+// Error rate drawn in full kHotKeyColor.
+constexpr double kHeatSaturation = 0.25;
+}  // namespace
 
 KeyboardWidget::KeyboardWidget(QWidget* parent) : QWidget(parent) {
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
@@ -10,130 +23,134 @@ KeyboardWidget::KeyboardWidget(QWidget* parent) : QWidget(parent) {
 }
 
 void KeyboardWidget::setLayout(Layout layout) {
+    if (layout == currentLayout) {
+        return;
+    }
     currentLayout = layout;
     setupLayout();
     update();
 }
 
 void KeyboardWidget::highlightKey(Qt::Key key, bool active) {
-    activeKey = key;
+    const int index = keyboardlayout::keyIndex(key);
+    if (index == activeKey && active == keyActive) {
+        return;
+    }
+    // Only the previously and the newly highlighted key change.
+    update(dirtyRect(activeKey));
+    activeKey = index;
     keyActive = active;
-    update();
+    update(dirtyRect(activeKey));
 }
 
-void KeyboardWidget::paintEvent(QPaintEvent* /*event*/) {
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
-
-    switch (currentLayout) {
-        case Layout::English:
-            paintEnglish(painter);
-            break;
-        case Layout::Russian:
-            paintRussian(painter);
-            break;
+void KeyboardWidget::setHeatmapVisible(bool visible) {
+    if (visible == heatmapVisible) {
+        return;
     }
+    heatmapVisible = visible;
+    update();
 }
 
-void KeyboardWidget::setupLayout() {
-    keyPositions.clear();
-
-    QStringList rows;
-    QStringList englishRows;
-
-    if (currentLayout == Layout::English) {
-        rows = {"1234567890", "QWERTYUIOP[]", "ASDFGHJKL;'", "ZXCVBNM,./", " SPACE "};
-        englishRows = rows;
-    } else if (currentLayout == Layout::Russian) {
-        rows = {"1234567890", "ЙЦУКЕНГШЩЗХЪ", "ФЫВАПРОЛДЖЭ", "ЯЧСМИТЬБЮ.", " SPACE "};
-        englishRows = {"1234567890", "QWERTYUIOP[]", "ASDFGHJKL;'", "ZXCVBNM,./", " SPACE "};
+void KeyboardWidget::setKeyHeat(int index, double errorRate) {
+    const auto level = static_cast<uint8_t>(
+        std::lround(std::clamp(errorRate / kHeatSaturation, 0.0, 1.0) * (kHeatLevels - 1)));
+    if (level == heatLevels[index]) {
+        return;
+    }
+    heatLevels[index] = level;
+    if (heatmapVisible) {
+        update(dirtyRect(index));
     }
+}
 
-    const int keyWidth = 50;
-    const int keyHeight = 50;
-    const int horizontalPadding = 20;
-    const int verticalPadding = 10;
-    for (int rowIdx = 0; rowIdx < rows.size(); ++rowIdx) {
-        const QString& chars = rows[rowIdx];
-        const QString& enChars = englishRows[rowIdx];
-        int y = verticalPadding + (rowIdx * (keyHeight + 5));
-        int xOffset = 0;
-
-        switch (rowIdx) {
-            case 0:
-                xOffset = keyWidth;
-                break;
-            case 1:
-                xOffset = 0;
-                break;
-            case 2:
-                xOffset = keyWidth / 2;
-                break;
-            case 3:
-                xOffset = keyWidth;
-                break;
-            case 4:
-                xOffset = keyWidth * 4;
-                break;
-        }
+void KeyboardWidget::setLatencyProbe(LatencyProbe* probe) {
+    latencyProbe = probe;
+}
 
-        if (rowIdx == 4) {
-            Qt::Key key = Qt::Key_Space;
-            KeyInfo info;
-            info.rect = QRect(horizontalPadding + xOffset, y, keyWidth * 5, keyHeight);
-            info.mainChar = ' ';
-            keyPositions[key] = info;
-            break;
+void KeyboardWidget::paintEvent(QPaintEvent* event) {
+    QPainter painter(this);
+    const QRect dirty = event->rect();
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setFont(keyFont());
+    if (heatmapVisible) {
+        // The colors change with every keystroke, so the keys are drawn directly; a keystroke
+        // dirties at most two of them.
+        for (int index = 0; index < keyboardlayout::kKeyCount; ++index) {
+            if (index != activeKey && dirty.intersects(dirtyRect(index))) {
+                paintKey(painter, index, heatColor(index));
+            }
         }
+    } else {
+        const QPixmap pixmap = keyboardPixmap();
+        const qreal ratio = pixmap.devicePixelRatio();
+        painter.drawPixmap(
+            dirty, pixmap,
+            QRectF(dirty.x() * ratio, dirty.y() * ratio, dirty.width() * ratio,
+                   dirty.height() * ratio));
+    }
 
-        for (int i = 0; i < chars.size(); ++i) {
-            QChar ruChar = chars[i];
-            QChar enChar = enChars[i];
-            Qt::Key key = static_cast<Qt::Key>(enChar.toUpper().unicode());
-
-            KeyInfo info;
-            info.rect =
-                QRect(horizontalPadding + xOffset + (i * (keyWidth + 5)), y, keyWidth, keyHeight);
-            info.mainChar = ruChar;
-            keyPositions[key] = info;
-        }
+    if (activeKey >= 0 && dirty.intersects(dirtyRect(activeKey))) {
+        paintKey(painter, activeKey, kActiveKeyColor);
+    }
+    if (latencyProbe != nullptr) {
+        latencyProbe->mark(LatencyProbe::Stage::KeyboardPaint);
     }
 }
 
-void KeyboardWidget::paintEnglish(QPainter& painter) {
-    painter.fillRect(rect(), Qt::transparent);
-
-    QFont font = painter.font();
-    font.setPointSize(10);
-    painter.setFont(font);
-
-    for (auto it = keyPositions.begin(); it != keyPositions.end(); ++it) {
-        const KeyInfo& key = it.value();
-        QColor color = (it.key() == activeKey) ? QColor(173, 216, 230) : QColor(200, 200, 200);
-
-        painter.setBrush(color);
-        painter.drawRoundedRect(key.rect, 5, 5);
-
-        QRect textRect = key.rect.adjusted(2, 2, -2, -2);
-        painter.drawText(textRect, Qt::AlignCenter, key.mainChar);
+void KeyboardWidget::setupLayout() {
+    for (int index = 0; index < keyboardlayout::kKeyCount; ++index) {
+        keyRects[index] = keyboardlayout::keyRect(index);
+        keyLegends[index] = keyboardlayout::keyLegend(currentLayout, index);
     }
 }
 
-void KeyboardWidget::paintRussian(QPainter& painter) {
-    painter.fillRect(rect(), Qt::transparent);
+QPixmap KeyboardWidget::keyboardPixmap() {
+    const qreal ratio = devicePixelRatioF();
+    const QString cacheKey = QString("KeyboardWidget/%1/%2/%3x%4")
+                                 .arg(static_cast<int>(currentLayout))
+                                 .arg(ratio)
+                                 .arg(width())
+                                 .arg(height());
+    QPixmap pixmap;
+    if (QPixmapCache::find(cacheKey, &pixmap)) {
+        return pixmap;
+    }
+    pixmap = QPixmap(size() * ratio);
+    pixmap.setDevicePixelRatio(ratio);
+    pixmap.fill(Qt::transparent);
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setFont(keyFont());
+    for (int index = 0; index < keyboardlayout::kKeyCount; ++index) {
+        paintKey(painter, index, kKeyColor);
+    }
+    painter.end();
+    QPixmapCache::insert(cacheKey, pixmap);
+    return pixmap;
+}
 
-    QFont font = painter.font();
-    font.setPointSize(10);
-    painter.setFont(font);
+QFont KeyboardWidget::keyFont() const {
+    QFont keyFont = font();
+    keyFont.setPointSize(10);
+    return keyFont;
+}
 
-    for (auto it = keyPositions.begin(); it != keyPositions.end(); ++it) {
-        const KeyInfo& key = it.value();
-        QColor color = (it.key() == activeKey) ? QColor(173, 216, 230) : QColor(200, 200, 200);
+QColor KeyboardWidget::heatColor(int index) const {
+    const float heat = static_cast<float>(heatLevels[index]) / (kHeatLevels - 1);
+    const auto mix = [heat](float from, float to) { return from + ((to - from) * heat); };
+    return QColor::fromRgbF(
+        mix(kKeyColor.redF(), kHotKeyColor.redF()), mix(kKeyColor.greenF(), kHotKeyColor.greenF()),
+        mix(kKeyColor.blueF(), kHotKeyColor.blueF()));
+}
 
-        painter.setBrush(color);
-        painter.drawRoundedRect(key.rect, 5, 5);
+void KeyboardWidget::paintKey(QPainter& painter, int index, const QColor& color) const {
+    painter.setBrush(color);
+    painter.drawRoundedRect(keyRects[index], 5, 5);
+    QRect textRect = keyRects[index].adjusted(2, 2, -2, -2);
+    painter.drawText(textRect, Qt::AlignCenter, QString(keyLegends[index]));
+}
 
-        QRect textRect = key.rect.adjusted(2, 2, -2, -2);
-        painter.drawText(textRect, Qt::AlignCenter, key.mainChar);
-    }
-}
\ No newline at end of file
+QRect KeyboardWidget::dirtyRect(int index) const {
+    // One extra pixel on each side for the antialiased outline.
+    return index < 0 ? QRect() : keyRects[index].adjusted(-1, -1, 1, 1);
+}
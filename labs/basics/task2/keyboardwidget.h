@@ -1,38 +1,56 @@
 #ifndef KEYBOARDWIDGET_H
 #define KEYBOARDWIDGET_H
 
-#include <QMap>
+#include "keyboardlayout.h"
+#include "latencyprobe.h"
+
+#include <QColor>
+#include <QFont>
+#include <QPixmap>
 #include <QWidget>
 #include <Qt>
+#include <array>
+#include <cstdint>
 
 class KeyboardWidget : public QWidget {
     Q_OBJECT
 
    public:
-    enum class Layout : int8_t { English, Russian };
+    using Layout = keyboardlayout::Layout;
 
     explicit KeyboardWidget(QWidget* parent = nullptr);
     void setLayout(Layout layout);
     void highlightKey(Qt::Key key, bool active);
+    // Colors every key by its error rate instead of plain gray.
+    void setHeatmapVisible(bool visible);
+    // `errorRate` of key `index` in [0, 1]; only the key repaints, and only if its color changes.
+    void setKeyHeat(int index, double errorRate);
+    // Receives the KeyboardPaint mark of every paint.
+    void setLatencyProbe(LatencyProbe* probe);
     Layout currentLayout = Layout::English;
 
    protected:
     void paintEvent(QPaintEvent* event) override;
 
    private:
-    struct KeyInfo {
-        QRect rect;
-        QString mainChar;
-        QString shiftChar;
-    };
-
     void setupLayout();
-    void paintEnglish(QPainter& painter);
-    void paintRussian(QPainter& painter);
-
-    QMap<Qt::Key, KeyInfo> keyPositions;
-    Qt::Key activeKey = Qt::Key_unknown;
+    // The keyboard without highlight, rendered once per layout and device pixel ratio.
+    QPixmap keyboardPixmap();
+    [[nodiscard]] QFont keyFont() const;
+    [[nodiscard]] QColor heatColor(int index) const;
+    void paintKey(QPainter& painter, int index, const QColor& color) const;
+    // Area to repaint when key `index` changes, empty for -1.
+    [[nodiscard]] QRect dirtyRect(int index) const;
+
+    // Indexed like the keys of keyboardlayout; the legends are those of `currentLayout`.
+    std::array<QRect, keyboardlayout::kKeyCount> keyRects;
+    std::array<QChar, keyboardlayout::kKeyCount> keyLegends;
+    // Error rate of every key, quantized to kHeatLevels steps.
+    std::array<uint8_t, keyboardlayout::kKeyCount> heatLevels{};
+    bool heatmapVisible = false;
+    int activeKey = -1;
     bool keyActive = false;
+    LatencyProbe* latencyProbe = nullptr;
 };
 
 #endif  // KEYBOARDWIDGET_H
\ No newline at end of file
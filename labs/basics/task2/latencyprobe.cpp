@@ -0,0 +1,140 @@
+// NOLINTBEGIN(readability-identifier-naming)
+#include "latencyprobe.h"
+
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace {
+constexpr std::array<const char*, LatencyProbe::kStages> kStageNames = {
+    "input", "display", "text paint", "keyboard paint"};
+}  // namespace
+
+void LatencyHistogram::record(int64_t micros) {
+    micros = std::max<int64_t>(micros, 0);
+    counts[bucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    int64_t seen = maxValue.load(std::memory_order_relaxed);
+    while (micros > seen &&
+           !maxValue.compare_exchange_weak(seen, micros, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (std::atomic<uint32_t>& bucket : counts) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    total.store(0, std::memory_order_relaxed);
+    maxValue.store(0, std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::count() const {
+    return total.load(std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::percentile(double percentile) const {
+    const int64_t samples = count();
+    if (samples == 0) {
+        return 0;
+    }
+    const auto rank = std::max<int64_t>(
+        1, static_cast<int64_t>(std::ceil(percentile / 100.0 * static_cast<double>(samples))));
+    int64_t seen = 0;
+    for (int bucket = 0; bucket < kBuckets; ++bucket) {
+        seen += counts[bucket].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(bucketUpperBound(bucket), max());
+        }
+    }
+    return max();
+}
+
+int64_t LatencyHistogram::max() const {
+    return maxValue.load(std::memory_order_relaxed);
+}
+
+int LatencyHistogram::bucketOf(int64_t micros) {
+    if (micros < kSubBuckets) {
+        return static_cast<int>(micros);
+    }
+    const int magnitude = std::bit_width(static_cast<uint64_t>(micros)) - 1;
+    const auto sub = static_cast<int>((micros >> (magnitude - 3)) & (kSubBuckets - 1));
+    return std::min(((magnitude - 2) * kSubBuckets) + sub, kBuckets - 1);
+}
+
+int64_t LatencyHistogram::bucketUpperBound(int bucket) {
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+    const int magnitude = (bucket / kSubBuckets) + 2;
+    const int64_t sub = bucket % kSubBuckets;
+    return ((kSubBuckets + sub + 1) << (magnitude - 3)) - 1;
+}
+
+LatencyProbe::LatencyProbe(int64_t staleAfterMs) : staleAfterNs(staleAfterMs * 1'000'000) {
+    clock.start();
+}
+
+void LatencyProbe::keyPressed() {
+    keyPressNs.store(clock.nsecsElapsed(), std::memory_order_relaxed);
+    keystroke.fetch_add(1, std::memory_order_release);
+}
+
+void LatencyProbe::mark(Stage stage) {
+    const uint64_t current = keystroke.load(std::memory_order_acquire);
+    const auto index = static_cast<size_t>(stage);
+    if (current == 0 || markedKeystroke[index].exchange(current, std::memory_order_relaxed) ==
+                            current) {
+        return;
+    }
+    const int64_t elapsedNs = clock.nsecsElapsed() - keyPressNs.load(std::memory_order_relaxed);
+    if (elapsedNs > staleAfterNs) {
+        return;
+    }
+    histograms[index].record(elapsedNs / 1000);
+}
+
+void LatencyProbe::reset() {
+    for (LatencyHistogram& histogram : histograms) {
+        histogram.reset();
+    }
+}
+
+const LatencyHistogram& LatencyProbe::histogram(Stage stage) const {
+    return histograms[static_cast<size_t>(stage)];
+}
+
+QString LatencyProbe::report() const {
+    QStringList lines;
+    for (int stage = 0; stage < kStages; ++stage) {
+        const LatencyHistogram& stageHistogram = histograms[stage];
+        lines.append(QString("%1: n=%2 p50=%3us p99=%4us max=%5us")
+                         .arg(kStageNames[stage])
+                         .arg(stageHistogram.count())
+                         .arg(stageHistogram.percentile(50))
+                         .arg(stageHistogram.percentile(99))
+                         .arg(stageHistogram.max()));
+    }
+    return lines.join('\n');
+}
+
+bool LatencyProbe::writeReport(const QString& fileName, QString& error) const {
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        error = file.errorString();
+        return false;
+    }
+    QTextStream out(&file);
+    out << "keystroke to stage latency\n" << report() << '\n';
+    out.flush();
+    if (out.status() != QTextStream::Ok) {
+        error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+// NOLINTEND(readability-identifier-naming)
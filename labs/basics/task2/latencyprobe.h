@@ -0,0 +1,68 @@
+#ifndef LATENCYPROBE_H
+#define LATENCYPROBE_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Log-linear histogram of microsecond values. record() is a relaxed atomic increment, so it can be
+// called from any thread and never blocks; the summary is approximate to 1/8 of the value.
+class LatencyHistogram {
+   public:
+    void record(int64_t micros);
+    void reset();
+
+    [[nodiscard]] int64_t count() const;
+    // Upper bound of the bucket that holds the `percentile`-th value, 0 when empty.
+    [[nodiscard]] int64_t percentile(double percentile) const;
+    [[nodiscard]] int64_t max() const;
+
+   private:
+    // 8 linear sub-buckets per power of two up to 2^27 us (about two minutes).
+    static constexpr int kSubBuckets = 8;
+    static constexpr int kBuckets = 25 * kSubBuckets;
+
+    static int bucketOf(int64_t micros);
+    static int64_t bucketUpperBound(int bucket);
+
+    std::array<std::atomic<uint32_t>, kBuckets> counts{};
+    std::atomic<int64_t> total = 0;
+    std::atomic<int64_t> maxValue = 0;
+};
+
+// Measures how long a keystroke takes to reach the screen.
+//
+// keyPressed() starts a keystroke; the first mark() of each stage records the time since then,
+// once per keystroke, so repaints that are not caused by typing do not skew the numbers. A stage
+// reached more than `staleAfterMs` after the keystroke is not recorded at all: by then the paint
+// is not the keystroke's, e.g. a widget that skipped the keystroke's repaint and is repainted much
+// later for another reason.
+class LatencyProbe {
+   public:
+    enum class Stage : uint8_t { Input, Display, TextPaint, KeyboardPaint };
+    static constexpr int kStages = 4;
+    static constexpr int64_t kStaleAfterMs = 1000;
+
+    explicit LatencyProbe(int64_t staleAfterMs = kStaleAfterMs);
+
+    void keyPressed();
+    void mark(Stage stage);
+    void reset();
+
+    [[nodiscard]] const LatencyHistogram& histogram(Stage stage) const;
+    // One line per stage with the sample count, p50, p99 and max in microseconds.
+    [[nodiscard]] QString report() const;
+    bool writeReport(const QString& fileName, QString& error) const;
+
+   private:
+    QElapsedTimer clock;
+    int64_t staleAfterNs;
+    std::atomic<int64_t> keyPressNs = 0;
+    std::atomic<uint64_t> keystroke = 0;
+    std::array<std::atomic<uint64_t>, kStages> markedKeystroke{};
+    std::array<LatencyHistogram, kStages> histograms;
+};
+
+#endif  // LATENCYPROBE_H
@@ -0,0 +1,57 @@
+// NOLINTBEGIN(readability-identifier-naming)
+#include "latencyprobe.h"
+
+#include <QThread>
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+int64_t count(const LatencyProbe& probe, LatencyProbe::Stage stage) {
+    return probe.histogram(stage).count();
+}
+}  // namespace
+
+TEST_CASE("LatencyHistogram keeps values up to 2^27 us apart") {
+    LatencyHistogram histogram;
+    histogram.record(100'000'000);
+    histogram.record(130'000'000);
+    // Both are in buckets of their own, 1/8 of the value wide, rather than in the overflow bucket.
+    CHECK(histogram.percentile(50) >= 100'000'000);
+    CHECK(histogram.percentile(50) < 113'000'000);
+    CHECK(histogram.percentile(100) == 130'000'000);
+}
+
+TEST_CASE("Each stage is recorded once per keystroke") {
+    LatencyProbe probe;
+    probe.mark(LatencyProbe::Stage::TextPaint);
+    CHECK(count(probe, LatencyProbe::Stage::TextPaint) == 0);
+
+    probe.keyPressed();
+    probe.mark(LatencyProbe::Stage::TextPaint);
+    probe.mark(LatencyProbe::Stage::TextPaint);
+    probe.mark(LatencyProbe::Stage::Display);
+    CHECK(count(probe, LatencyProbe::Stage::TextPaint) == 1);
+    CHECK(count(probe, LatencyProbe::Stage::Display) == 1);
+    CHECK(count(probe, LatencyProbe::Stage::KeyboardPaint) == 0);
+
+    probe.keyPressed();
+    probe.mark(LatencyProbe::Stage::TextPaint);
+    CHECK(count(probe, LatencyProbe::Stage::TextPaint) == 2);
+}
+
+TEST_CASE("A stale keystroke is not charged to a later paint") {
+    LatencyProbe probe(10);
+    probe.keyPressed();
+    probe.mark(LatencyProbe::Stage::TextPaint);
+    // The keyboard is not repainted for this keystroke, only much later for something else.
+    QThread::msleep(50);
+    probe.mark(LatencyProbe::Stage::KeyboardPaint);
+    CHECK(count(probe, LatencyProbe::Stage::TextPaint) == 1);
+    CHECK(count(probe, LatencyProbe::Stage::KeyboardPaint) == 0);
+
+    // The next keystroke is measured again.
+    probe.keyPressed();
+    probe.mark(LatencyProbe::Stage::KeyboardPaint);
+    CHECK(count(probe, LatencyProbe::Stage::KeyboardPaint) == 1);
+}
+
+// NOLINTEND(readability-identifier-naming)
@@ -0,0 +1,36 @@
+// NOLINTBEGIN(readability-identifier-naming)
+#include "lineindex.h"
+
+#include <algorithm>
+
+void LineIndex::reset(QStringView text, int charPerLine) {
+    this->text = text;
+    setCharPerLine(charPerLine);
+}
+
+void LineIndex::setCharPerLine(int charPerLine) {
+    width = std::max(charPerLine, 1);
+}
+
+int LineIndex::charPerLine() const {
+    return width;
+}
+
+qsizetype LineIndex::lineCount() const {
+    return (text.size() + width - 1) / width;
+}
+
+qsizetype LineIndex::lineStart(qsizetype index) const {
+    return std::min(index * width, text.size());
+}
+
+QStringView LineIndex::line(qsizetype index) const {
+    const qsizetype start = lineStart(index);
+    return text.sliced(start, std::min<qsizetype>(width, text.size() - start));
+}
+
+qsizetype LineIndex::lineLength(qsizetype index) const {
+    return line(index).size();
+}
+
+// NOLINTEND(readability-identifier-naming)
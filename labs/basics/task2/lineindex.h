@@ -0,0 +1,29 @@
+#ifndef LINEINDEX_H
+#define LINEINDEX_H
+
+#include <QString>
+#include <QStringView>
+
+// Splits the training text into lines of `charPerLine` characters without copying it.
+//
+// Lines are views into the text, computed on demand from their index, so the cost of switching
+// to another width or of asking for any line is independent of the text size. The text must
+// outlive the index and must not be modified while it is indexed.
+class LineIndex {
+   public:
+    void reset(QStringView text, int charPerLine);
+    void setCharPerLine(int charPerLine);
+
+    [[nodiscard]] int charPerLine() const;
+    [[nodiscard]] qsizetype lineCount() const;
+    // Offset of the first character of line `index` in the text.
+    [[nodiscard]] qsizetype lineStart(qsizetype index) const;
+    [[nodiscard]] QStringView line(qsizetype index) const;
+    [[nodiscard]] qsizetype lineLength(qsizetype index) const;
+
+   private:
+    QStringView text;
+    int width = 80;
+};
+
+#endif  // LINEINDEX_H
@@ -1,6 +1,9 @@
 // NOLINTBEGIN(cppcoreguidelines-owning-memory, readability-identifier-naming)
 #include "mainwindow.h"
 
+#include "keyboardlayout.h"
+#include "textloader.h"
+
 #include <QApplication>
 #include <QFileDialog>
 #include <QGraphicsDropShadowEffect>
@@ -10,28 +13,53 @@
 #include <QMenuBar>
 #include <QMessageBox>
 #include <QPropertyAnimation>
+#include <QRandomGenerator>
 #include <QTimer>
 
+namespace {
+// Slowest bigrams a drill practices, and its length.
+constexpr int kDrillBigrams = 10;
+constexpr int kDrillWords = 1000;
+// A session with no keystroke for this long pauses itself, so the stats stop ticking.
+constexpr int64_t kIdlePauseMs = 5000;
+}  // namespace
+
 MainWindow::MainWindow(QWidget* parent)
-    : QMainWindow(parent), textDisplay(new QLabel(this)), alignmentGroup(new QActionGroup(this)) {
+    : QMainWindow(parent)
+    , textDisplay(new TypingTextWidget(this))
+    , alignmentGroup(new QActionGroup(this)) {
     SetupUi();
+    sessionClock.start();
+    indexPool.setMaxThreadCount(1);
+    statsTimer.setSingleShot(true);
+    connect(&statsTimer, &QTimer::timeout, this, [this] {
+        if (sessionClock.elapsed() - lastKeystrokeMs >= kIdlePauseMs) {
+            // The typing stopped at the last keystroke, not when this tick noticed.
+            pauseSession(lastKeystrokeMs);
+            return;
+        }
+        updateStats();
+        scheduleStatsTick();
+    });
     startNewSession();
-    connect(&statsTimer, &QTimer::timeout, this, &MainWindow::updateStats);
-    statsTimer.start(500);
 }
 
-MainWindow::~MainWindow() = default;
+MainWindow::~MainWindow() {
+    // Both threads report back to this window. Queued index builds are dropped; a running one has
+    // to finish.
+    ++loadGeneration;
+    if (loaderThread) {
+        loaderThread->wait();
+    }
+    indexPool.clear();
+    indexPool.waitForDone();
+}
 
 void MainWindow::SetupUi() {
     auto* centralWidget = new QWidget(this);
     auto* mainLayout = new QVBoxLayout(centralWidget);
     // TEXT DISPLAY
     trainingText = "The quick brown fox jumps over the lazy dog";
-    textDisplay->setAlignment(Qt::AlignCenter);
-    textDisplay->setWordWrap(false);
-    textDisplay->setStyleSheet(
-        "font-size: 28px; font-family: monospace; margin: 30px; color: #2c3e50;");
-
     QFontMetrics metrics(textDisplay->font());
     int charWidth = metrics.horizontalAdvance('X');
     textDisplay->setMinimumWidth((charPerLine * charWidth) + 40);
@@ -65,17 +93,35 @@ void MainWindow::SetupUi() {
     QMenu* fileMenu = menuBar->addMenu("File");
     setMenuBar(menuBar);
 
-    auto* openAction = new QAction("Open File", this);
+    openAction = new QAction("Open File", this);
     openAction->setShortcut(QKeySequence::Open);
     alignmentGroup->addAction(openAction);
     fileMenu->addAction(openAction);
 
+    drillAction = new QAction("Generate Drill", this);
+    drillAction->setShortcut(Qt::CTRL | Qt::Key_D);
+    drillAction->setEnabled(false);
+    fileMenu->addAction(drillAction);
+
+    auto* exportLatencyAction = new QAction("Export Latency Report", this);
+    fileMenu->addAction(exportLatencyAction);
+
+    QMenu* viewMenu = menuBar->addMenu("View");
+    auto* latencyOverlayAction = new QAction("Latency Overlay", this);
+    latencyOverlayAction->setCheckable(true);
+    latencyOverlayAction->setShortcut(Qt::Key_F12);
+    viewMenu->addAction(latencyOverlayAction);
+    auto* heatmapAction = new QAction("Error Heatmap", this);
+    heatmapAction->setCheckable(true);
+    heatmapAction->setShortcut(Qt::CTRL | Qt::Key_H);
+    viewMenu->addAction(heatmapAction);
+
     // STATS
     auto* statsContainer = new QFrame(this);
     statsContainer->setStyleSheet("border-radius: 8px; padding: 12px;");
 
     auto* topLayout = new QHBoxLayout;
-    statsLabel = new QLabel("WPM: 0.00 | Accuracy: 0.0% | Time: 00:00");
+    statsLabel = new QLabel("WPM: 0.00 | Last 10 s: 0.00 | Accuracy: 0.0% | Time: 00:00");
     statsLabel->setStyleSheet("font-size: 16px; color: #34495e; font-weight: 500;");
     auto* statsInnerLayout = new QHBoxLayout(statsContainer);
     statsInnerLayout->addWidget(statsLabel);
@@ -94,6 +140,14 @@ void MainWindow::SetupUi() {
 
     saluteAnimGroup = new QParallelAnimationGroup(this);
 
+    // LATENCY OVERLAY
+    latencyOverlay = new QLabel(centralWidget);
+    latencyOverlay->setStyleSheet(
+        "font-family: monospace; font-size: 12px; color: #ecf0f1;"
+        "background-color: rgba(44, 62, 80, 0.8); border-radius: 6px; padding: 6px;");
+    latencyOverlay->move(10, 10);
+    latencyOverlay->hide();
+
     auto* posAnim = new QPropertyAnimation(saluteEffect, "pos", this);
     posAnim->setDuration(1200);
     posAnim->setEasingCurve(QEasingCurve::OutQuad);
@@ -115,13 +169,17 @@ void MainWindow::SetupUi() {
     radioEnableKeyboard->setFocusPolicy(Qt::NoFocus);
 
     keyboardWidget = new KeyboardWidget(this);
+    keyboardWidget->setLatencyProbe(&latencyProbe);
+    textDisplay->setLatencyProbe(&latencyProbe);
     auto* keyboardLayout = new QHBoxLayout;
     keyboardLayout->addWidget(keyboardWidget);
 
     layoutComboBox = new QComboBox(this);
     layoutComboBox->setFocusPolicy(Qt::NoFocus);
-    layoutComboBox->addItem("English", static_cast<int>(KeyboardWidget::Layout::English));
-    layoutComboBox->addItem("Russian", static_cast<int>(KeyboardWidget::Layout::Russian));
+    for (int layout = 0; layout < keyboardlayout::kLayoutCount; ++layout) {
+        layoutComboBox->addItem(
+            keyboardlayout::layoutName(static_cast<keyboardlayout::Layout>(layout)), layout);
+    }
 
     keyboardTopLayout->addWidget(radioEnableKeyboard, 0, Qt::AlignLeft);
     keyboardTopLayout->addWidget(layoutComboBox);
@@ -141,6 +199,14 @@ void MainWindow::SetupUi() {
 
     // CONNECTIONS
     connect(openAction, &QAction::triggered, this, &MainWindow::loadTrainingText);
+    connect(drillAction, &QAction::triggered, this, &MainWindow::generateDrill);
+    connect(exportLatencyAction, &QAction::triggered, this, &MainWindow::exportLatencyReport);
+    connect(latencyOverlayAction, &QAction::toggled, this, [this](bool visible) {
+        latencyOverlay->setVisible(visible);
+        updateLatencyOverlay();
+    });
+    connect(
+        heatmapAction, &QAction::toggled, keyboardWidget, &KeyboardWidget::setHeatmapVisible);
     connect(radioEnableKeyboard, &QRadioButton::toggled, keyboardWidget, &QWidget::setVisible);
     connect(radioEnableKeyboard, &QRadioButton::toggled, layoutComboBox, &QWidget::setVisible);
     connect(
@@ -152,6 +218,14 @@ void MainWindow::onLayoutChanged(int index) {
     QVariant data = layoutComboBox->itemData(index);
     auto layout = static_cast<KeyboardWidget::Layout>(data.toInt());
     keyboardWidget->setLayout(layout);
+    analytics.setLayout(layout);
+    updateHeatmap();
+}
+
+void MainWindow::updateHeatmap() {
+    for (int key = 0; key < keyboardlayout::kKeyCount; ++key) {
+        keyboardWidget->setKeyHeat(key, analytics.errorRate(key));
+    }
 }
 
 void MainWindow::loadTrainingText() {
@@ -162,22 +236,90 @@ void MainWindow::loadTrainingText() {
         return;
     }
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QMessageBox::warning(this, "Error", "Could not open the file.");
+    // Large corpora take a while to decode; the session starts once the worker hands the text
+    // back to the GUI thread.
+    // Open File stays disabled until the text is applied, so the wait below only ever covers a
+    // loader that has already handed its text back.
+    openAction->setEnabled(false);
+    drillAction->setEnabled(false);
+    drillIndex.reset();
+    const uint64_t generation = ++loadGeneration;
+    if (loaderThread) {
+        loaderThread->wait();
+    }
+    loaderThread.reset(QThread::create([this, fileName, generation] {
+        QString text;
+        QString error;
+        const bool ok = loadTrainingTextFile(fileName, text, error);
+        QMetaObject::invokeMethod(
+            this, [this, generation, ok, text, error] {
+                applyTrainingText(generation, ok, text, error);
+            },
+            Qt::QueuedConnection);
+        if (!ok) {
+            return;
+        }
+        // The session starts right away; the drill index follows once it is mapped or built. A
+        // build still queued when the next file is opened is skipped, and the result of a running
+        // one is dropped by applyDrillIndex.
+        indexPool.start([this, fileName, generation, text] {
+            if (generation != loadGeneration) {
+                return;
+            }
+            auto index = std::make_shared<DrillIndex>();
+            index->open(DrillIndex::cacheFileFor(fileName), text);
+            QMetaObject::invokeMethod(
+                this, [this, generation, index] { applyDrillIndex(generation, index); },
+                Qt::QueuedConnection);
+        });
+    }));
+    loaderThread->start();
+}
+
+void MainWindow::applyTrainingText(
+    uint64_t generation, bool ok, const QString& text, const QString& error) {
+    if (generation != loadGeneration) {
         return;
     }
+    openAction->setEnabled(true);
+    if (!ok) {
+        QMessageBox::warning(this, "Error", "Could not open the file: " + error);
+        return;
+    }
+    trainingText = text;
+    startNewSession();
+}
 
-    QTextStream in(&file);
-    QString filteredText;
-    for (const QChar& c : in.readAll()) {
-        if (c.isLetterOrNumber() || c.isSpace() || c.isPunct()) {
-            filteredText.append(c);
-        }
+void MainWindow::applyDrillIndex(uint64_t generation, std::shared_ptr<DrillIndex> index) {
+    if (generation != loadGeneration) {
+        return;
     }
-    trainingText = filteredText;
-    file.close();
+    drillIndex = std::move(index);
+    drillAction->setEnabled(!drillIndex->isEmpty());
+}
 
+void MainWindow::generateDrill() {
+    if (!drillIndex) {
+        return;
+    }
+    // The slowest bigrams are physical keys; the corpus is indexed by the lowercase characters on
+    // them in the current layout.
+    const keyboardlayout::Layout layout = analytics.layout();
+    std::vector<DrillIndex::Bigram> bigrams;
+    for (const TypingAnalytics::Bigram& slow : analytics.slowestBigrams(kDrillBigrams)) {
+        bigrams.push_back(
+            {keyboardlayout::keyLegend(layout, slow.from).toLower(),
+             keyboardlayout::keyLegend(layout, slow.to).toLower(), slow.meanMs});
+    }
+    const QString drill = drillIndex->generate(bigrams, kDrillWords, *QRandomGenerator::global());
+    if (drill.isEmpty()) {
+        QMessageBox::information(
+            this, "Generate Drill",
+            "Not enough typing yet to find slow key pairs in this text. Keep typing and try "
+            "again.");
+        return;
+    }
+    trainingText = drill;
     startNewSession();
 }
 
@@ -185,8 +327,28 @@ void MainWindow::resizeEvent(QResizeEvent* event) {
     QMainWindow::resizeEvent(event);
     QFontMetrics metrics(textDisplay->font());
     int availableWidth = textDisplay->width() - 80;
-    charPerLine = std::min(80, availableWidth / metrics.averageCharWidth());
-    startNewSession();
+    int newCharPerLine = std::clamp(availableWidth / metrics.averageCharWidth(), 1, 80);
+    // Most resize ticks do not change the wrap width. A new width moves the cursor onto the new
+    // lines and keeps the session and its stats running.
+    if (newCharPerLine == charPerLine) {
+        return;
+    }
+    rewrap(newCharPerLine);
+}
+
+void MainWindow::rewrap(int newCharPerLine) {
+    const qsizetype offset = lineIndex.lineStart(currentLineIndex) + currentPositionInLine;
+    charPerLine = newCharPerLine;
+    lineIndex.setCharPerLine(charPerLine);
+    // The end of one line and the start of the next are the same offset; a finished text keeps
+    // the cursor at the end of its last line.
+    qsizetype line = offset / charPerLine;
+    if (line > 0 && line >= lineIndex.lineCount()) {
+        line = lineIndex.lineCount() - 1;
+    }
+    currentLineIndex = static_cast<int>(line);
+    currentPositionInLine = static_cast<int>(offset - lineIndex.lineStart(line));
+    updateDisplay();
 }
 
 void MainWindow::startNewSession() {
@@ -194,124 +356,76 @@ void MainWindow::startNewSession() {
     currentPositionInLine = 0;
     totalTyped = 0;
     correctTyped = 0;
-    sessionActive = false;
-    activeTimer.invalidate();
-    pausedTimer.invalidate();
-    activems = 0;
-    pausedms = 0;
+    sessionTime.reset();
+    statsTimer.stop();
+    analytics.startSession();
     updateStats();
 
     if (!trainingText.isEmpty()) {
-        Qt::Key key = static_cast<Qt::Key>(trainingText.at(0).toUpper().unicode());
-        keyboardWidget->highlightKey(key, false);
+        keyboardWidget->highlightKey(
+            keyboardlayout::keyForChar(keyboardWidget->currentLayout, trainingText.at(0)), false);
     }
 
-    trainingLines.clear();
-    for (int i = 0; i < trainingText.length(); i += charPerLine) {
-        trainingLines.append(trainingText.mid(i, charPerLine));
-    }
+    lineIndex.reset(trainingText, charPerLine);
+    textDisplay->clear();
 
     updateDisplay();
 }
 
 void MainWindow::updateDisplay() {
-    if (trainingLines.isEmpty() || currentLineIndex >= trainingLines.size()) {
-        textDisplay->setText("");
+    if (currentLineIndex >= lineIndex.lineCount()) {
+        textDisplay->clear();
         return;
     }
 
-    QString currentLine = trainingLines[currentLineIndex];
-    QString formattedCurrentLine;
-    for (int i = 0; i < currentLine.length(); ++i) {
-        QString color;
-        if (i < currentPositionInLine) {
-            color = "green";
-        } else if (i == currentPositionInLine) {
-            color = sessionActive ? "blue" : "gray";
-        } else {
-            color = "gray";
-        }
-
-        QChar character = currentLine[i];
-        if (character == ' ') {
-            character = QChar(0x00B7);  // '·'
-        }
-
-        formattedCurrentLine +=
-            QString("<span style='color: %1'>%2</span>").arg(color).arg(character);
-    }
+    const QStringView currentLine = lineIndex.line(currentLineIndex);
+    const QStringView nextLine = currentLineIndex + 1 < lineIndex.lineCount()
+                                     ? lineIndex.line(currentLineIndex + 1)
+                                     : QStringView();
+    textDisplay->setLines(currentLine, nextLine);
+    textDisplay->setCursorPosition(currentPositionInLine, sessionTime.isActive());
 
     QChar nextChar;
     if (currentPositionInLine < currentLine.length()) {
         nextChar = currentLine[currentPositionInLine];
-    }
-    QString nextLine;
-    if (currentLineIndex + 1 < trainingLines.size()) {
-        nextLine = trainingLines[currentLineIndex + 1];
-        nextLine.replace(' ', QChar(0x00B7));
-        if (currentPositionInLine >= currentLine.length()) {
-            nextChar = trainingLines[currentLineIndex + 1].at(0);
-            QString firstChar = QString("<span style='color: blue;'>%1</span>").arg(nextLine.at(0));
-            nextLine.remove(0, 1);
-            nextLine = firstChar + QString("<span style='color: gray'>%1</span>").arg(nextLine);
-        } else {
-            nextLine = QString("<span style='color: gray'>%1</span>").arg(nextLine);
-        }
+    } else if (!nextLine.isEmpty()) {
+        nextChar = nextLine.at(0);
     }
 
     if (!nextChar.isNull()) {
-        Qt::Key key = static_cast<Qt::Key>(nextChar.toUpper().unicode());
-
-        if (keyboardWidget->currentLayout == KeyboardWidget::Layout::Russian) {
-            static QHash<QChar, Qt::Key> ruToEnKeys = {
-              {QString("Й")[0], Qt::Key_Q},
-              {QString("Ц")[0], Qt::Key_W},
-              {QString("У")[0], Qt::Key_E},
-              {QString("К")[0], Qt::Key_R},
-              {QString("Е")[0], Qt::Key_T},
-              {QString("Н")[0], Qt::Key_Y},
-              {QString("Г")[0], Qt::Key_U},
-              {QString("Ш")[0], Qt::Key_I},
-              {QString("Щ")[0], Qt::Key_O},
-              {QString("З")[0], Qt::Key_P},
-              {QString("Ф")[0], Qt::Key_A},
-              {QString("Ы")[0], Qt::Key_S},
-              {QString("В")[0], Qt::Key_D},
-              {QString("А")[0], Qt::Key_F},
-              {QString("П")[0], Qt::Key_G},
-              {QString("Р")[0], Qt::Key_H},
-              {QString("О")[0], Qt::Key_J},
-              {QString("Л")[0], Qt::Key_K},
-              {QString("Д")[0], Qt::Key_L},
-              {QString("Ж")[0], Qt::Key_Semicolon},
-              {QString("Я")[0], Qt::Key_Z},
-              {QString("Ч")[0], Qt::Key_X},
-              {QString("С")[0], Qt::Key_C},
-              {QString("М")[0], Qt::Key_V},
-              {QString("И")[0], Qt::Key_B},
-              {QString("Т")[0], Qt::Key_N},
-              {QString("Ь")[0], Qt::Key_M},
-              {QString("Б")[0], Qt::Key_Comma},
-              {QString("Ю")[0], Qt::Key_Period},
-              {'.', Qt::Key_Slash}  // Добавляем это сопоставление
-            };
-
-            if (ruToEnKeys.contains(nextChar.toUpper())) {
-                key = ruToEnKeys[nextChar.toUpper()];
-            }
-        }
-
-        keyboardWidget->highlightKey(key, false);
+        keyboardWidget->highlightKey(
+            keyboardlayout::keyForChar(keyboardWidget->currentLayout, nextChar), false);
     }
 
-    textDisplay->setText(formattedCurrentLine + "<br/>" + nextLine);
-
     qsizetype totalChars = trainingText.length();
     int currentPos = (currentLineIndex * charPerLine) + currentPositionInLine;
     int progress = (totalChars > 0)
                        ? static_cast<int>((static_cast<qsizetype>(currentPos * 100)) / totalChars)
                        : 0;
     progressBar->setValue(progress);
+    latencyProbe.mark(LatencyProbe::Stage::Display);
+}
+
+void MainWindow::updateLatencyOverlay() {
+    // The paint stages of this keystroke land after the event returns, so the overlay shows them
+    // from the next keystroke on.
+    if (latencyOverlay->isVisible()) {
+        latencyOverlay->setText(latencyProbe.report());
+        latencyOverlay->adjustSize();
+        latencyOverlay->raise();
+    }
+}
+
+void MainWindow::exportLatencyReport() {
+    QString fileName = QFileDialog::getSaveFileName(
+        this, "Export Latency Report", "latency.txt", "Text Files (*.txt)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    QString error;
+    if (!latencyProbe.writeReport(fileName, error)) {
+        QMessageBox::warning(this, "Error", "Could not write the report: " + error);
+    }
 }
 
 void MainWindow::keyPressEvent(QKeyEvent* event) {
@@ -323,7 +437,12 @@ void MainWindow::keyPressEvent(QKeyEvent* event) {
         textPaused->show();
         return;
     }
-    if (!sessionActive) {
+    if (event->key() == Qt::Key_Backspace ||
+        (event->key() != Qt::Key_Tab && !event->text().isEmpty())) {
+        latencyProbe.keyPressed();
+    }
+    lastKeystrokeMs = sessionClock.elapsed();
+    if (!sessionTime.isActive()) {
         resumeSession();
         textPaused->hide();
     }
@@ -335,65 +454,78 @@ void MainWindow::keyPressEvent(QKeyEvent* event) {
     } else if (!event->text().isEmpty()) {
         processInput(event->text());
     }
+    updateLatencyOverlay();
 
     QMainWindow::keyPressEvent(event);
 }
 
 void MainWindow::pauseSession() {
-    if (!sessionActive) {
+    pauseSession(sessionClock.elapsed());
+}
+
+void MainWindow::pauseSession(int64_t atMs) {
+    if (!sessionTime.isActive()) {
         return;
     }
-    if (activeTimer.isValid()) {
-        activems += activeTimer.elapsed();
-    }
+    sessionTime.pause(atMs);
     statsTimer.stop();
-    activeTimer.invalidate();
-    pausedTimer.start();
-    sessionActive = false;
+    updateStats();
 }
 
 void MainWindow::resumeSession() {
-    if (sessionActive) {
+    if (sessionTime.isActive()) {
         return;
     }
-    if (pausedTimer.isValid()) {
-        pausedms += pausedTimer.elapsed();
+    sessionTime.resume(sessionClock.elapsed());
+    scheduleStatsTick();
+}
+
+void MainWindow::scheduleStatsTick() {
+    if (sessionTime.isActive()) {
+        statsTimer.start(static_cast<int>(1000 - (elapsedMs() % 1000)));
     }
-    statsTimer.start(500);
-    pausedTimer.invalidate();
-    activeTimer.start();
-    sessionActive = true;
+}
+
+int64_t MainWindow::elapsedMs() const {
+    return sessionTime.elapsedMs(sessionClock.elapsed());
 }
 
 void MainWindow::processInput(const QString& input) {
-    if (trainingLines.isEmpty() || currentLineIndex >= trainingLines.size()) {
+    if (currentLineIndex >= lineIndex.lineCount()) {
         startNewSession();
         return;
     }
 
-    QString currentLine = trainingLines[currentLineIndex];
+    QStringView currentLine = lineIndex.line(currentLineIndex);
     if (currentPositionInLine >= currentLine.length()) {
         currentLineIndex++;
         currentPositionInLine = 0;
-        if (currentLineIndex >= trainingLines.size()) {
+        if (currentLineIndex >= lineIndex.lineCount()) {
             showCompletionMessage();
             return;
         }
-        currentLine = trainingLines[currentLineIndex];
+        currentLine = lineIndex.line(currentLineIndex);
     }
 
-    bool correct = (input == currentLine.at(currentPositionInLine));
+    const QChar expected = currentLine.at(currentPositionInLine);
+    const int key = analytics.record(sessionClock.elapsed(), expected, input.at(0));
+    if (key >= 0) {
+        keyboardWidget->setKeyHeat(key, analytics.errorRate(key));
+    }
+    bool correct = (input == expected);
     if (correct) {
         currentPositionInLine++;
         correctTyped++;
     }
     totalTyped++;
+    latencyProbe.mark(LatencyProbe::Stage::Input);
 
     updateDisplay();
+    updateStats();
 
-    if (currentLineIndex >= trainingLines.size() ||
-        (currentLineIndex == trainingLines.size() - 1 &&
-         currentPositionInLine >= trainingLines[currentLineIndex].length())) {
+    if (currentLineIndex >= lineIndex.lineCount() ||
+        (currentLineIndex == lineIndex.lineCount() - 1 &&
+         currentPositionInLine >= lineIndex.lineLength(currentLineIndex))) {
         showCompletionMessage();
     }
 }
@@ -407,14 +539,16 @@ void MainWindow::handleBackspace() {
         }
     } else if (currentLineIndex > 0) {
         currentLineIndex--;
-        currentPositionInLine = static_cast<int>(trainingLines[currentLineIndex].length()) - 1;
+        currentPositionInLine = static_cast<int>(lineIndex.lineLength(currentLineIndex)) - 1;
         totalTyped++;
         if (correctTyped > 0) {
             correctTyped--;
         }
     }
+    latencyProbe.mark(LatencyProbe::Stage::Input);
 
     updateDisplay();
+    updateStats();
 }
 
 void MainWindow::showCompletionMessage() {
@@ -436,29 +570,34 @@ void MainWindow::showCompletionMessage() {
 }
 
 void MainWindow::updateStats() {
-    if (sessionActive) {
-        pauseSession();
-        resumeSession();
+    const int64_t elapsed = elapsedMs();
+    const double minutesDouble = static_cast<double>(elapsed) / 60000.0;
+    const double wpm = (minutesDouble > 0) ? (correctTyped / 5.0) / minutesDouble : 0.0;
+    const double accuracy = (totalTyped > 0) ? (correctTyped * 100.0 / totalTyped) : 0.0;
+    const double rollingWpm = analytics.rollingWpm(sessionClock.elapsed());
+
+    // Most keystrokes and ticks leave the rounded values as they are; the label is only rebuilt
+    // and repainted when one of them changes.
+    const std::array<int64_t, 4> stats = {
+        qRound64(wpm * 100), qRound64(rollingWpm * 100), qRound64(accuracy * 10),
+        elapsed / 1000};
+    if (stats == displayedStats) {
+        return;
     }
-    qint64 elapsed = activems;
+    displayedStats = stats;
 
-    int totalSeconds = static_cast<int>(elapsed / 1000);
-    int minutes = totalSeconds / 60;
-    int seconds = totalSeconds % 60;
+    const int64_t totalSeconds = stats[3];
     QString timeString = QString("%1:%2")
-                             .arg(minutes, 2, 10, QLatin1Char('0'))
-                             .arg(seconds, 2, 10, QLatin1Char('0'));
-
-    double minutesDouble = static_cast<double>(elapsed) / 60000.0;
-    double wpm = (minutesDouble > 0) ? (correctTyped / 5.0) / minutesDouble : 0.0;
-    double accuracy = (totalTyped > 0) ? (correctTyped * 100.0 / totalTyped) : 0.0;
-
+                             .arg(totalSeconds / 60, 2, 10, QLatin1Char('0'))
+                             .arg(totalSeconds % 60, 2, 10, QLatin1Char('0'));
     statsLabel->setText(
         QString("<b>WPM:</b> <span style='color: #2980b9;'>%1</span> | "
-                "<b>Accuracy:</b> <span style='color: #27ae60;'>%2%</span> | "
-                "<b>Time:</b> <span style='color: #8e44ad;'>%3</span>")
-            .arg(wpm, 0, 'f', 2)
-            .arg(accuracy, 0, 'f', 1)
+                "<b>Last 10 s:</b> <span style='color: #2980b9;'>%2</span> | "
+                "<b>Accuracy:</b> <span style='color: #27ae60;'>%3%</span> | "
+                "<b>Time:</b> <span style='color: #8e44ad;'>%4</span>")
+            .arg(static_cast<double>(stats[0]) / 100, 0, 'f', 2)
+            .arg(static_cast<double>(stats[1]) / 100, 0, 'f', 2)
+            .arg(static_cast<double>(stats[2]) / 10, 0, 'f', 1)
             .arg(timeString));
 }
 
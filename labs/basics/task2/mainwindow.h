@@ -1,7 +1,13 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include "drillindex.h"
 #include "keyboardwidget.h"
+#include "latencyprobe.h"
+#include "lineindex.h"
+#include "sessiontime.h"
+#include "typinganalytics.h"
+#include "typingtextwidget.h"
 
 #include <QActionGroup>
 #include <QComboBox>
@@ -11,7 +17,12 @@
 #include <QParallelAnimationGroup>
 #include <QProgressBar>
 #include <QRadioButton>
+#include <QThread>
+#include <QThreadPool>
 #include <QTimer>
+#include <array>
+#include <atomic>
+#include <memory>
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -28,45 +39,74 @@ class MainWindow : public QMainWindow {
     void loadTrainingText();
     void updateStats();
     void onLayoutChanged(int index);
+    void exportLatencyReport();
+    void generateDrill();
 
    private:
     void SetupUi();
     void pauseSession();
+    // Stops counting active time at `atMs` on the session clock, e.g. at the last keystroke.
+    void pauseSession(int64_t atMs);
     void resumeSession();
+    // Wakes up when the displayed time changes next; only runs while typing, and pauses the
+    // session once no key was pressed for a while.
+    void scheduleStatsTick();
+    // Active typing time, read from the session clock.
+    [[nodiscard]] int64_t elapsedMs() const;
     void startNewSession();
+    void rewrap(int newCharPerLine);
     void updateDisplay();
     void processInput(const QString& input);
     void handleBackspace();
     void showCompletionMessage();
+    // Both drop results of a file that is no longer the last one opened.
+    void applyTrainingText(
+        uint64_t generation, bool ok, const QString& text, const QString& error);
+    void applyDrillIndex(uint64_t generation, std::shared_ptr<DrillIndex> index);
+    void updateLatencyOverlay();
+    void updateHeatmap();
 
     // UI
     KeyboardWidget* keyboardWidget;
     QComboBox* layoutComboBox;
+    QAction* openAction;
+    QAction* drillAction;
     QRadioButton* radioEnableKeyboard;
-    QLabel* textDisplay;
+    TypingTextWidget* textDisplay;
     QLabel* textPaused;
     QLabel* statsLabel;
     QLabel* saluteEffect;
+    QLabel* latencyOverlay;
     QProgressBar* progressBar;
     QParallelAnimationGroup* saluteAnimGroup;
     QActionGroup* alignmentGroup;
     int charPerLine = 80;
 
     // Training Data
+    // Decodes the file; the drill index is then built on indexPool, so that opening the next file
+    // never waits for it.
+    std::unique_ptr<QThread> loaderThread;
+    QThreadPool indexPool;
+    // Counts opened files; a result tagged with an older count is stale.
+    std::atomic<uint64_t> loadGeneration = 0;
     QString trainingText;
-    QStringList trainingLines;
+    // Index of the last loaded file.
+    std::shared_ptr<DrillIndex> drillIndex;
+    LineIndex lineIndex;
     int currentLineIndex = 0;
     int currentPositionInLine = 0;
 
     // Stats
+    LatencyProbe latencyProbe;
+    TypingAnalytics analytics;
     QTimer statsTimer;
-    QElapsedTimer activeTimer;
-    QElapsedTimer pausedTimer;
-    int64_t activems = 0;
-    int64_t pausedms = 0;
+    QElapsedTimer sessionClock;
+    SessionTime sessionTime;
+    int64_t lastKeystrokeMs = 0;
+    // WPM and rolling WPM in hundredths, accuracy in tenths of a percent and seconds as last shown.
+    std::array<int64_t, 4> displayedStats{-1, -1, -1, -1};
     int totalTyped = 0;
     int correctTyped = 0;
-    bool sessionActive = false;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,35 @@
+// NOLINTBEGIN(readability-identifier-naming)
+#include "sessiontime.h"
+
+#include <algorithm>
+
+void SessionTime::reset() {
+    activeMs = 0;
+    active = false;
+}
+
+void SessionTime::resume(int64_t nowMs) {
+    if (active) {
+        return;
+    }
+    activeSinceMs = nowMs;
+    active = true;
+}
+
+void SessionTime::pause(int64_t atMs) {
+    if (!active) {
+        return;
+    }
+    activeMs += std::max<int64_t>(atMs - activeSinceMs, 0);
+    active = false;
+}
+
+bool SessionTime::isActive() const {
+    return active;
+}
+
+int64_t SessionTime::elapsedMs(int64_t nowMs) const {
+    return active ? activeMs + (nowMs - activeSinceMs) : activeMs;
+}
+
+// NOLINTEND(readability-identifier-naming)
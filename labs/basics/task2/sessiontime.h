@@ -0,0 +1,26 @@
+#ifndef SESSIONTIME_H
+#define SESSIONTIME_H
+
+#include <cstdint>
+
+// Active typing time of a session. Time only counts between resume() and pause(); all times are
+// read from one monotonic clock in milliseconds.
+class SessionTime {
+   public:
+    void reset();
+    void resume(int64_t nowMs);
+    // Stops counting at `atMs`, which may lie in the past: a session that went idle pauses at its
+    // last keystroke, so the idle stretch before the pause is not counted.
+    void pause(int64_t atMs);
+
+    [[nodiscard]] bool isActive() const;
+    [[nodiscard]] int64_t elapsedMs(int64_t nowMs) const;
+
+   private:
+    // Active time before the current stretch of typing, and the clock time it started at.
+    int64_t activeMs = 0;
+    int64_t activeSinceMs = 0;
+    bool active = false;
+};
+
+#endif  // SESSIONTIME_H
@@ -0,0 +1,39 @@
+// NOLINTBEGIN(readability-identifier-naming)
+#include "sessiontime.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("Only the time between resume and pause counts") {
+    SessionTime time;
+    CHECK_FALSE(time.isActive());
+    CHECK(time.elapsedMs(1000) == 0);
+
+    time.resume(1000);
+    CHECK(time.isActive());
+    CHECK(time.elapsedMs(1500) == 500);
+    time.pause(3000);
+    CHECK(time.elapsedMs(10'000) == 2000);
+
+    time.resume(20'000);
+    CHECK(time.elapsedMs(20'250) == 2250);
+
+    time.reset();
+    CHECK_FALSE(time.isActive());
+    CHECK(time.elapsedMs(30'000) == 0);
+}
+
+TEST_CASE("An idle session paused at its last keystroke does not count the idle time") {
+    SessionTime time;
+    time.resume(0);
+    const int64_t lastKeystrokeMs = 4000;
+    // The idle check notices five seconds later.
+    time.pause(lastKeystrokeMs);
+    CHECK(time.elapsedMs(9000) == 4000);
+
+    // A pause at a time before the stretch started counts nothing rather than going negative.
+    time.resume(10'000);
+    time.pause(9990);
+    CHECK(time.elapsedMs(15'000) == 4000);
+}
+
+// NOLINTEND(readability-identifier-naming)
@@ -0,0 +1,77 @@
+// NOLINTBEGIN(readability-identifier-naming)
+#include "textloader.h"
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QFile>
+#include <QStringDecoder>
+#include <algorithm>
+#include <array>
+
+namespace {
+constexpr qsizetype kDecodeChunk = qsizetype{64} << 10;
+
+bool isTrainingChar(QChar c) {
+    return c.isLetterOrNumber() || c.isSpace() || c.isPunct();
+}
+
+// The same predicate as a flat table for ASCII, which makes up most of any corpus. '\r' is
+// dropped so that CRLF files behave like QIODevice::Text.
+const std::array<bool, 128>& asciiTable() {
+    static const std::array<bool, 128> table = [] {
+        std::array<bool, 128> result{};
+        for (char16_t c = 0; c < result.size(); ++c) {
+            result[c] = c != u'\r' && isTrainingChar(QChar(c));
+        }
+        return result;
+    }();
+    return table;
+}
+
+// Copies the accepted characters of [from, end) to `to`, which may alias `from`.
+QChar* filterChars(const QChar* from, const QChar* end, QChar* to) {
+    const std::array<bool, 128>& ascii = asciiTable();
+    for (; from != end; ++from) {
+        const char16_t c = from->unicode();
+        if (c < ascii.size() ? ascii[c] : isTrainingChar(*from)) {
+            *to++ = *from;
+        }
+    }
+    return to;
+}
+}  // namespace
+
+bool loadTrainingTextFile(const QString& fileName, QString& text, QString& error) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    QByteArray fallback;
+    QByteArrayView bytes;
+    const qint64 size = file.size();
+    if (const uchar* data = size > 0 ? file.map(0, size) : nullptr; data != nullptr) {
+        bytes = QByteArrayView(data, size);
+    } else {
+        // Not mappable, e.g. a pipe or a special file.
+        fallback = file.readAll();
+        bytes = fallback;
+    }
+
+    // UTF-8 never decodes into more UTF-16 code units than it has bytes, so decoding chunk after
+    // chunk behind the filtered output never overtakes the end of the buffer.
+    QStringDecoder decoder(QStringDecoder::Utf8);
+    text.resize(bytes.size());
+    QChar* const begin = text.data();
+    QChar* out = begin;
+    for (qsizetype offset = 0; offset < bytes.size(); offset += kDecodeChunk) {
+        const QByteArrayView chunk =
+            bytes.sliced(offset, std::min(kDecodeChunk, bytes.size() - offset));
+        QChar* const decoded = decoder.appendToBuffer(out, chunk);
+        out = filterChars(out, decoded, out);
+    }
+    text.truncate(out - begin);
+    return true;
+}
+
+// NOLINTEND(readability-identifier-naming)
@@ -0,0 +1,14 @@
+#ifndef TEXTLOADER_H
+#define TEXTLOADER_H
+
+#include <QString>
+
+// Reads `fileName` as UTF-8 and keeps only letters, digits, whitespace and punctuation, the
+// characters the trainer can ask for. Line endings are normalized to '\n'.
+//
+// The file is memory-mapped and decoded in cache-sized chunks straight into `text`, which is
+// allocated once up front; every chunk is filtered in place right after it is decoded. Safe to
+// call from any thread.
+bool loadTrainingTextFile(const QString& fileName, QString& text, QString& error);
+
+#endif  // TEXTLOADER_H
@@ -0,0 +1,134 @@
+// NOLINTBEGIN(readability-identifier-naming)
+#include "typinganalytics.h"
+
+#include <algorithm>
+
+void KeystrokeLog::append(const Keystroke& keystroke) {
+    entries[appended % kCapacity] = keystroke;
+    ++appended;
+}
+
+void KeystrokeLog::clear() {
+    appended = 0;
+}
+
+uint64_t KeystrokeLog::end() const {
+    return appended;
+}
+
+int KeystrokeLog::size() const {
+    return static_cast<int>(std::min<uint64_t>(appended, kCapacity));
+}
+
+const KeystrokeLog::Keystroke& KeystrokeLog::at(uint64_t sequence) const {
+    return entries[sequence % kCapacity];
+}
+
+void TypingAnalytics::setLayout(keyboardlayout::Layout layout) {
+    if (layout == currentLayout) {
+        return;
+    }
+    currentLayout = layout;
+    resetKeys();
+}
+
+keyboardlayout::Layout TypingAnalytics::layout() const {
+    return currentLayout;
+}
+
+int TypingAnalytics::record(int64_t timeMs, QChar expected, QChar typed) {
+    const bool correct = expected == typed;
+    const int key = keyboardlayout::keyIndex(keyboardlayout::keyForChar(currentLayout, expected));
+    if (key >= 0) {
+        ++keys[key].expected;
+        keys[key].errors += correct ? 0 : 1;
+    }
+    const int64_t gap = timeMs - previousTimeMs;
+    if (correct && previousCorrect && previousKey >= 0 && key >= 0 && gap >= 0 &&
+        gap <= kMaxBigramGapMs) {
+        BigramStats& bigram = bigrams[(previousKey * kKeys) + key];
+        ++bigram.samples;
+        bigram.totalMs += gap;
+    }
+    previousKey = key;
+    previousTimeMs = timeMs;
+    previousCorrect = correct;
+
+    // A full log overwrites its oldest keystroke next; if that one is still in the window (which
+    // takes more than 400 keystrokes a second), it leaves the window first.
+    if (events.size() == KeystrokeLog::kCapacity &&
+        windowStart == events.end() - KeystrokeLog::kCapacity) {
+        const KeystrokeLog::Keystroke& oldest = events.at(windowStart++);
+        windowCorrect -= oldest.expected == oldest.typed ? 1 : 0;
+    }
+    events.append({static_cast<uint32_t>(timeMs), expected.unicode(), typed.unicode()});
+    windowCorrect += correct ? 1 : 0;
+    if (firstTimeMs < 0) {
+        firstTimeMs = timeMs;
+    }
+    advanceWindow(timeMs);
+    return key;
+}
+
+void TypingAnalytics::startSession() {
+    events.clear();
+    windowStart = 0;
+    windowCorrect = 0;
+    firstTimeMs = -1;
+    previousKey = -1;
+    previousCorrect = false;
+}
+
+double TypingAnalytics::errorRate(int key) const {
+    const KeyStats& stats = keys[key];
+    return stats.expected > 0 ? static_cast<double>(stats.errors) / stats.expected : 0.0;
+}
+
+double TypingAnalytics::bigramLatency(int from, int to) const {
+    const BigramStats& bigram = bigrams[(from * kKeys) + to];
+    return bigram.samples > 0 ? static_cast<double>(bigram.totalMs) / bigram.samples : 0.0;
+}
+
+std::vector<TypingAnalytics::Bigram> TypingAnalytics::slowestBigrams(
+    int count, int minSamples) const {
+    std::vector<Bigram> result;
+    for (int from = 0; from < kKeys; ++from) {
+        for (int to = 0; to < kKeys; ++to) {
+            if (bigrams[(from * kKeys) + to].samples >= static_cast<uint32_t>(minSamples)) {
+                result.push_back({from, to, bigramLatency(from, to)});
+            }
+        }
+    }
+    const auto middle = result.begin() + std::clamp<std::ptrdiff_t>(count, 0, std::ssize(result));
+    std::partial_sort(result.begin(), middle, result.end(), [](const Bigram& a, const Bigram& b) {
+        return a.meanMs > b.meanMs;
+    });
+    result.erase(middle, result.end());
+    return result;
+}
+
+double TypingAnalytics::rollingWpm(int64_t nowMs) {
+    if (firstTimeMs < 0) {
+        return 0.0;
+    }
+    advanceWindow(nowMs);
+    // Right after the first keystroke the window is only as long as the typing so far.
+    const int64_t span = std::clamp<int64_t>(nowMs - firstTimeMs, 1000, kRollingWindowMs);
+    return (windowCorrect / 5.0) / (static_cast<double>(span) / 60000.0);
+}
+
+void TypingAnalytics::resetKeys() {
+    keys.fill({});
+    bigrams.fill({});
+    previousKey = -1;
+    previousCorrect = false;
+}
+
+void TypingAnalytics::advanceWindow(int64_t nowMs) {
+    while (windowStart < events.end() && events.at(windowStart).timeMs < nowMs - kRollingWindowMs) {
+        const KeystrokeLog::Keystroke& oldest = events.at(windowStart++);
+        windowCorrect -= oldest.expected == oldest.typed ? 1 : 0;
+    }
+}
+
+// NOLINTEND(readability-identifier-naming)
@@ -0,0 +1,98 @@
+#ifndef TYPINGANALYTICS_H
+#define TYPINGANALYTICS_H
+
+#include "keyboardlayout.h"
+
+#include <QChar>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// The most recent keystrokes, oldest first. Once the log is full every keystroke overwrites the
+// oldest one, so it never holds more than kCapacity entries.
+class KeystrokeLog {
+   public:
+    struct Keystroke {
+        uint32_t timeMs;
+        char16_t expected;
+        char16_t typed;
+    };
+    static constexpr int kCapacity = 4096;
+
+    void append(const Keystroke& keystroke);
+    void clear();
+
+    // Sequence number the next keystroke gets. Keystrokes from end() - size() on are kept.
+    [[nodiscard]] uint64_t end() const;
+    [[nodiscard]] int size() const;
+    [[nodiscard]] const Keystroke& at(uint64_t sequence) const;
+
+   private:
+    std::array<Keystroke, kCapacity> entries{};
+    uint64_t appended = 0;
+};
+
+// Per-key error rates, per-bigram latencies and a rolling WPM, updated in constant time per
+// keystroke from fixed-size tables, so memory stays the same however long the user types.
+//
+// Keys and bigrams are physical keys of the current layout: a character is counted on the key
+// that types it. Switching the layout starts the key statistics over; a new session only starts the
+// rolling window over and keeps them.
+class TypingAnalytics {
+   public:
+    struct Bigram {
+        int from;
+        int to;
+        double meanMs;
+    };
+    // Longer gaps between two keystrokes are pauses and are not counted as bigram latency.
+    static constexpr int64_t kMaxBigramGapMs = 2000;
+    static constexpr int64_t kRollingWindowMs = 10'000;
+
+    void setLayout(keyboardlayout::Layout layout);
+    [[nodiscard]] keyboardlayout::Layout layout() const;
+    // Returns the key of `expected`, -1 if the layout has none.
+    int record(int64_t timeMs, QChar expected, QChar typed);
+    // Empties the rolling window and forgets the previous keystroke, so no bigram spans two
+    // sessions. The per-key and bigram statistics are kept.
+    void startSession();
+
+    // Share of the keystrokes expected on `key` that were wrong, 0 if it was never expected.
+    [[nodiscard]] double errorRate(int key) const;
+    // Mean time from a correct `from` to a correct `to`, 0 without samples.
+    [[nodiscard]] double bigramLatency(int from, int to) const;
+    // Up to `count` bigrams with at least `minSamples` samples, slowest first.
+    [[nodiscard]] std::vector<Bigram> slowestBigrams(int count, int minSamples = 3) const;
+    // Words per minute over the last kRollingWindowMs before `nowMs`.
+    [[nodiscard]] double rollingWpm(int64_t nowMs);
+
+   private:
+    struct KeyStats {
+        uint32_t expected = 0;
+        uint32_t errors = 0;
+    };
+    struct BigramStats {
+        uint32_t samples = 0;
+        uint64_t totalMs = 0;
+    };
+    static constexpr int kKeys = keyboardlayout::kKeyCount;
+
+    void resetKeys();
+    // Drops the keystrokes before `nowMs` - kRollingWindowMs from the rolling window.
+    void advanceWindow(int64_t nowMs);
+
+    keyboardlayout::Layout currentLayout = keyboardlayout::Layout::English;
+    KeystrokeLog events;
+    std::array<KeyStats, kKeys> keys{};
+    std::array<BigramStats, kKeys * kKeys> bigrams{};
+    // Key, time and correctness of the previous keystroke, for the bigram it starts.
+    int previousKey = -1;
+    int64_t previousTimeMs = 0;
+    bool previousCorrect = false;
+    // First keystroke in the rolling window and the correct keystrokes from it on.
+    uint64_t windowStart = 0;
+    int windowCorrect = 0;
+    int64_t firstTimeMs = -1;
+};
+
+#endif  // TYPINGANALYTICS_H
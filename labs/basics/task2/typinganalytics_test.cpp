@@ -0,0 +1,108 @@
+// NOLINTBEGIN(readability-identifier-naming)
+#include "typinganalytics.h"
+
+#include "keyboardlayout.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+namespace {
+int keyOf(char16_t character) {
+    return keyboardlayout::keyIndex(
+        keyboardlayout::keyForChar(keyboardlayout::Layout::English, QChar(character)));
+}
+
+// Types `first` then `second` `gapMs` later, `samples` times, each pair in a session of its own.
+void typePair(
+    TypingAnalytics& analytics, char16_t first, char16_t second, int64_t gapMs, int samples) {
+    for (int i = 0; i < samples; ++i) {
+        analytics.startSession();
+        analytics.record(i * 10'000, QChar(first), QChar(first));
+        analytics.record((i * 10'000) + gapMs, QChar(second), QChar(second));
+    }
+}
+}  // namespace
+
+TEST_CASE("KeystrokeLog keeps the newest kCapacity keystrokes") {
+    KeystrokeLog log;
+    constexpr int kAppended = KeystrokeLog::kCapacity + 10;
+    for (int i = 0; i < kAppended; ++i) {
+        log.append({static_cast<uint32_t>(i), u'a', u'a'});
+    }
+    CHECK(log.size() == KeystrokeLog::kCapacity);
+    CHECK(log.end() == kAppended);
+    CHECK(log.at(log.end() - 1).timeMs == kAppended - 1);
+    CHECK(log.at(log.end() - KeystrokeLog::kCapacity).timeMs == 10);
+
+    log.clear();
+    CHECK(log.size() == 0);
+    CHECK(log.end() == 0);
+}
+
+TEST_CASE("The rolling window drops keystrokes the full log overwrites") {
+    TypingAnalytics analytics;
+    // More keystrokes than the log holds, all within one second: the window is limited by the
+    // log, not by time.
+    constexpr int kTyped = KeystrokeLog::kCapacity + 1000;
+    for (int i = 0; i < kTyped; ++i) {
+        analytics.record(i / 10, QChar(u'a'), QChar(u'a'));
+    }
+    const double expected = (KeystrokeLog::kCapacity / 5.0) / (1000.0 / 60000.0);
+    CHECK(analytics.rollingWpm(1000) == expected);
+}
+
+TEST_CASE("The rolling window evicts keystrokes older than kRollingWindowMs") {
+    TypingAnalytics analytics;
+    for (int i = 0; i < 10; ++i) {
+        analytics.record(i * 100, QChar(u'a'), QChar(u'a'));
+    }
+    // Only a second of typing so far: the window is that long.
+    CHECK(analytics.rollingWpm(1000) == (10 / 5.0) / (1000.0 / 60000.0));
+
+    // Wrong keystrokes are in the window but do not count.
+    analytics.record(20'000, QChar(u'a'), QChar(u's'));
+    for (int i = 1; i <= 5; ++i) {
+        analytics.record(20'000 + (i * 100), QChar(u'a'), QChar(u'a'));
+    }
+    CHECK(analytics.rollingWpm(20'500) == (5 / 5.0) / (10'000.0 / 60000.0));
+    CHECK(analytics.rollingWpm(40'000) == 0.0);
+}
+
+TEST_CASE("slowestBigrams orders by mean latency and skips rare bigrams") {
+    TypingAnalytics analytics;
+    typePair(analytics, u'd', u'f', 100, 3);
+    typePair(analytics, u'a', u's', 300, 4);
+    typePair(analytics, u'j', u'k', 200, 3);
+    // Slowest of all, but with too few samples.
+    typePair(analytics, u'g', u'h', 900, 2);
+
+    const std::vector<TypingAnalytics::Bigram> slowest = analytics.slowestBigrams(10);
+    REQUIRE(slowest.size() == 3);
+    CHECK(slowest[0].from == keyOf(u'a'));
+    CHECK(slowest[0].to == keyOf(u's'));
+    CHECK(slowest[0].meanMs == 300.0);
+    CHECK(slowest[1].from == keyOf(u'j'));
+    CHECK(slowest[1].meanMs == 200.0);
+    CHECK(slowest[2].from == keyOf(u'd'));
+    CHECK(slowest[2].meanMs == 100.0);
+
+    const std::vector<TypingAnalytics::Bigram> top = analytics.slowestBigrams(1);
+    REQUIRE(top.size() == 1);
+    CHECK(top[0].from == keyOf(u'a'));
+    CHECK(analytics.slowestBigrams(10, 2).size() == 4);
+}
+
+TEST_CASE("A new session keeps the key statistics but not the previous keystroke") {
+    TypingAnalytics analytics;
+    analytics.record(0, QChar(u'a'), QChar(u'q'));
+    analytics.record(100, QChar(u's'), QChar(u's'));
+    analytics.startSession();
+    CHECK(analytics.rollingWpm(200) == 0.0);
+    analytics.record(200, QChar(u'f'), QChar(u'f'));
+
+    CHECK(analytics.bigramLatency(keyOf(u's'), keyOf(u'f')) == 0.0);
+    CHECK(analytics.errorRate(keyOf(u'a')) == 1.0);
+    CHECK(analytics.errorRate(keyOf(u's')) == 0.0);
+}
+
+// NOLINTEND(readability-identifier-naming)
@@ -0,0 +1,144 @@
+// NOLINTBEGIN(readability-identifier-naming)
+#include "typingtextwidget.h"
+
+#include <QColor>
+#include <QFont>
+#include <QFontMetricsF>
+#include <QLatin1Char>
+#include <QList>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QRectF>
+#include <QString>
+#include <QTextCharFormat>
+#include <QTextLine>
+
+namespace {
+const QColor kTypedColor("green");
+const QColor kCursorColor("blue");
+const QColor kPendingColor("gray");
+
+QTextLayout::FormatRange coloredRange(int start, int length, const QColor& color) {
+    QTextLayout::FormatRange range;
+    range.start = start;
+    range.length = length;
+    range.format.setForeground(color);
+    return range;
+}
+}  // namespace
+
+TypingTextWidget::TypingTextWidget(QWidget* parent) : QWidget(parent) {
+    QFont textFont("monospace");
+    textFont.setStyleHint(QFont::Monospace);
+    textFont.setPixelSize(28);
+    setFont(textFont);
+    setContentsMargins(30, 30, 30, 30);
+}
+
+void TypingTextWidget::setLines(QStringView current, QStringView next) {
+    const auto same = [](QStringView a, QStringView b) {
+        return a.data() == b.data() && a.size() == b.size();
+    };
+    if (same(lines[0].source, current) && same(lines[1].source, next)) {
+        return;
+    }
+    layoutLine(lines[0], current);
+    layoutLine(lines[1], next);
+    update();
+}
+
+void TypingTextWidget::setCursorPosition(int position, bool active) {
+    if (position == cursor && active == cursorActive) {
+        return;
+    }
+    // Only the old and the new cursor character change color.
+    update(charRect(cursor));
+    cursor = position;
+    cursorActive = active;
+    update(charRect(cursor));
+}
+
+void TypingTextWidget::clear() {
+    layoutLine(lines[0], {});
+    layoutLine(lines[1], {});
+    cursor = 0;
+    update();
+}
+
+void TypingTextWidget::setLatencyProbe(LatencyProbe* probe) {
+    latencyProbe = probe;
+}
+
+void TypingTextWidget::paintEvent(QPaintEvent* event) {
+    QPainter painter(this);
+    painter.setPen(kPendingColor);
+    const QColor cursorColor = cursorActive ? kCursorColor : kPendingColor;
+    const int currentLength = static_cast<int>(lines[0].source.size());
+    for (int row = 0; row < static_cast<int>(lines.size()); ++row) {
+        if (lines[row].source.isEmpty()) {
+            continue;
+        }
+        QList<QTextLayout::FormatRange> formats;
+        if (row == 0) {
+            formats.append(coloredRange(0, cursor, kTypedColor));
+            formats.append(coloredRange(cursor, 1, cursorColor));
+        } else if (cursor >= currentLength) {
+            formats.append(coloredRange(0, 1, cursorColor));
+        }
+        lines[row].layout.draw(&painter, lineOrigin(row), formats, event->rect());
+    }
+    if (latencyProbe != nullptr) {
+        latencyProbe->mark(LatencyProbe::Stage::TextPaint);
+    }
+}
+
+void TypingTextWidget::layoutLine(Line& line, QStringView text) {
+    line.source = text;
+    // Spaces are shown as middle dots so that they can be seen and typed.
+    QString shown = text.toString();
+    shown.replace(QLatin1Char(' '), QChar(0x00B7));
+    line.layout.clearLayout();
+    line.layout.setFont(font());
+    line.layout.setText(shown);
+    line.layout.setCacheEnabled(true);
+    line.layout.beginLayout();
+    QTextLine textLine = line.layout.createLine();
+    if (textLine.isValid()) {
+        textLine.setNumColumns(static_cast<int>(shown.size()));
+        textLine.setPosition({0, 0});
+    }
+    line.layout.endLayout();
+}
+
+QPointF TypingTextWidget::lineOrigin(int row) const {
+    const QRect area = contentsRect();
+    const qreal lineHeight = QFontMetricsF(font()).lineSpacing();
+    const qreal width = lines[row].layout.lineCount() > 0
+                            ? lines[row].layout.lineAt(0).naturalTextWidth()
+                            : 0.0;
+    return {
+        area.left() + ((area.width() - width) / 2),
+        area.top() + ((area.height() - (lineHeight * 2)) / 2) + (lineHeight * row)};
+}
+
+QRect TypingTextWidget::charRect(int position) const {
+    int row = 0;
+    if (position >= lines[0].source.size()) {
+        row = 1;
+        position = 0;
+    }
+    const QTextLayout& layout = lines[row].layout;
+    if (layout.lineCount() == 0 || position >= lines[row].source.size()) {
+        return {};
+    }
+    const QTextLine textLine = layout.lineAt(0);
+    const QPointF origin = lineOrigin(row);
+    const qreal left = textLine.cursorToX(position);
+    const qreal right = textLine.cursorToX(position + 1);
+    // One extra pixel on each side for antialiased glyph edges.
+    return QRectF(origin.x() + left, origin.y(), right - left, textLine.height())
+        .toAlignedRect()
+        .adjusted(-1, -1, 1, 1);
+}
+
+// NOLINTEND(readability-identifier-naming)
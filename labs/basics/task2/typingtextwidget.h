@@ -0,0 +1,54 @@
+#ifndef TYPINGTEXTWIDGET_H
+#define TYPINGTEXTWIDGET_H
+
+#include "latencyprobe.h"
+
+#include <QPointF>
+#include <QRect>
+#include <QStringView>
+#include <QTextLayout>
+#include <QWidget>
+#include <array>
+
+// Shows the line being typed and the line after it, centered, with typed characters in green and
+// the cursor character highlighted.
+//
+// Each line is shaped once into a QTextLayout when it is set. Moving the cursor only invalidates
+// the rectangles of the old and the new cursor character, and painting draws the cached glyphs
+// clipped to them, so a keystroke costs the same for any line length.
+class TypingTextWidget : public QWidget {
+    Q_OBJECT
+
+   public:
+    explicit TypingTextWidget(QWidget* parent = nullptr);
+
+    // Lays out `current` and `next` unless they are the lines already shown. Both views must stay
+    // valid until the next call or clear().
+    void setLines(QStringView current, QStringView next);
+    // Moves the cursor to `position` in the current line. The end of the current line puts it on
+    // the first character of the next line. An inactive cursor is drawn like untyped text.
+    void setCursorPosition(int position, bool active);
+    void clear();
+    // Receives the TextPaint mark of every paint.
+    void setLatencyProbe(LatencyProbe* probe);
+
+   protected:
+    void paintEvent(QPaintEvent* event) override;
+
+   private:
+    struct Line {
+        QStringView source;
+        QTextLayout layout;
+    };
+
+    void layoutLine(Line& line, QStringView text);
+    [[nodiscard]] QPointF lineOrigin(int row) const;
+    [[nodiscard]] QRect charRect(int position) const;
+
+    std::array<Line, 2> lines;
+    int cursor = 0;
+    bool cursorActive = false;
+    LatencyProbe* latencyProbe = nullptr;
+};
+
+#endif  // TYPINGTEXTWIDGET_H
@@ -0,0 +1,195 @@
+// Headless batch exporter: runs several queries against one database concurrently and writes each
+// result to its own CSV file.
+//
+//   batch_export --database sqlite:///var/db/outfit.db \
+//       --query "SELECT * FROM items" --output items.csv \
+//       --query "SELECT * FROM looks" --output looks.csv.zst --compression zstd
+
+#include "compressing_device.h"
+#include "csv_export_job.h"
+#include "tools/util/util.h"
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+#include <QUrl>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace {
+using outfit::utils::csv::Codec;
+using outfit::utils::csv::CompressionOptions;
+using outfit::utils::csv::CsvExportJob;
+
+constexpr auto kConnection = "batch_export";
+
+struct Job {
+    QString sql;
+    QString output;
+    std::unique_ptr<CsvExportJob> export_job;
+    Timer timer;
+    double seconds = 0.0;
+    bool ok = false;
+};
+
+// Maps sqlite://, postgresql:// and mysql:// URLs onto a Qt SQL driver.
+//
+// SQLite URLs must name an absolute path, sqlite:///path/to.db. In sqlite://data.db the file name
+// would be the URL's host, which QUrl lowercases, so that form is rejected rather than guessed at.
+bool OpenDatabase(const QUrl& url, QString& error) {
+    const QString scheme = url.scheme();
+    QString driver;
+    if (scheme == "sqlite") {
+        driver = "QSQLITE";
+    } else if (scheme == "postgresql" || scheme == "postgres") {
+        driver = "QPSQL";
+    } else if (scheme == "mysql") {
+        driver = "QMYSQL";
+    } else {
+        error = "unsupported database scheme: " + scheme;
+        return false;
+    }
+    if (driver == "QSQLITE" && (!url.host().isEmpty() || !url.path().startsWith('/'))) {
+        error = "SQLite URLs take an absolute path, e.g. sqlite:///path/to.db; got " +
+                url.toString();
+        return false;
+    }
+    QSqlDatabase database = QSqlDatabase::addDatabase(driver, kConnection);
+    if (driver == "QSQLITE") {
+        database.setDatabaseName(url.path());
+    } else {
+        database.setHostName(url.host());
+        if (url.port() != -1) {
+            database.setPort(url.port());
+        }
+        database.setUserName(url.userName());
+        database.setPassword(url.password());
+        database.setDatabaseName(url.path().mid(1));
+        database.setConnectOptions(url.query());
+    }
+    if (!database.open()) {
+        error = "failed to open database: " + database.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool ParseCodec(const QString& name, Codec& codec) {
+    if (name == "none") {
+        codec = Codec::None;
+    } else if (name == "gzip") {
+        codec = Codec::Gzip;
+    } else if (name == "zstd") {
+        codec = Codec::Zstd;
+    } else {
+        return false;
+    }
+    return true;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Exports query results to CSV files concurrently.");
+    parser.addHelpOption();
+    const QCommandLineOption database_option(
+        "database", "Database URL, e.g. sqlite:///path/to.db or postgresql://user@host/db.",
+        "url");
+    const QCommandLineOption query_option("query", "SQL query; repeat once per job.", "sql");
+    const QCommandLineOption output_option(
+        "output", "Output file of the matching --query.", "path");
+    const QCommandLineOption compression_option(
+        "compression", "none, gzip or zstd.", "codec", "none");
+    const QCommandLineOption parallel_option(
+        "parallel", "Jobs running at the same time.", "count",
+        QString::number(QThread::idealThreadCount()));
+    parser.addOptions(
+        {database_option, query_option, output_option, compression_option, parallel_option});
+    parser.process(app);
+
+    const QStringList queries = parser.values(query_option);
+    const QStringList outputs = parser.values(output_option);
+    if (!parser.isSet(database_option) || queries.isEmpty() || queries.size() != outputs.size()) {
+        err << "expected --database and one --output per --query\n";
+        return 2;
+    }
+    CompressionOptions compression;
+    if (!ParseCodec(parser.value(compression_option), compression.codec)) {
+        err << "unknown compression: " << parser.value(compression_option) << '\n';
+        return 2;
+    }
+    const int parallel = std::max(parser.value(parallel_option).toInt(), 1);
+
+    QString error;
+    if (!OpenDatabase(QUrl(parser.value(database_option)), error)) {
+        err << error << '\n';
+        return 1;
+    }
+    const QSqlDatabase database = QSqlDatabase::database(kConnection);
+
+    const Timer total_timer;
+    std::vector<Job> jobs(queries.size());
+    size_t next = 0;
+    size_t finished = 0;
+    // Every job clones the connection on its own worker thread; at most `parallel` run at once.
+    auto start_next = [&] {
+        Job& job = jobs[next++];
+        job.timer = Timer();
+        job.export_job->Start(database, job.sql);
+    };
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        Job& job = jobs[i];
+        job.sql = queries[static_cast<qsizetype>(i)];
+        job.output = outputs[static_cast<qsizetype>(i)];
+        job.export_job = std::make_unique<CsvExportJob>(QString(), job.output);
+        job.export_job->SetHeaderFromColumns(true);
+        job.export_job->SetCompression(compression);
+        QObject::connect(job.export_job.get(), &CsvExportJob::Finished, &app, [&, i](bool ok) {
+            jobs[i].ok = ok;
+            jobs[i].seconds = std::chrono::duration<double>(jobs[i].timer.GetTimes().wall_time)
+                                  .count();
+            if (next < jobs.size()) {
+                start_next();
+            }
+            if (++finished == jobs.size()) {
+                QCoreApplication::quit();
+            }
+        });
+    }
+    while (next < std::min(jobs.size(), static_cast<size_t>(parallel))) {
+        start_next();
+    }
+    QCoreApplication::exec();
+
+    int status = 0;
+    for (const Job& job : jobs) {
+        const double rows = static_cast<double>(job.export_job->RowsWritten());
+        out << job.output << ": ";
+        if (job.ok) {
+            out << job.export_job->RowsWritten() << " rows, " << job.seconds << " s, "
+                << (job.seconds > 0 ? rows / job.seconds : 0.0) << " rows/s\n";
+        } else {
+            out << "FAILED: " << job.export_job->ErrorString() << '\n';
+            status = 1;
+        }
+    }
+    const auto total = total_timer.GetTimes();
+    out << "total: " << std::chrono::duration<double>(total.wall_time).count() << " s wall, "
+        << std::chrono::duration<double>(total.cpu_time).count() << " s cpu\n";
+#ifdef __linux__
+    out << "peak RSS: " << GetMemoryUsage() << " KiB\n";
+#endif
+    return status;
+}
@@ -0,0 +1,162 @@
+#include "bulk_inserter.h"
+
+#include <QSqlDriver>
+#include <QSqlError>
+#include <QStringLiteral>
+#include <algorithm>
+#include <utility>
+
+namespace outfit::utils {
+namespace {
+// Escapes every part of a "schema.table" name on its own; a name the caller already quoted is used
+// as is, since it may contain dots of its own.
+QString EscapeTableName(const QSqlDriver& driver, const QString& table) {
+    if (driver.isIdentifierEscaped(table, QSqlDriver::TableName)) {
+        return table;
+    }
+    QStringList parts = table.split(QLatin1Char('.'));
+    for (QString& part : parts) {
+        part = driver.escapeIdentifier(part, QSqlDriver::TableName);
+    }
+    return parts.join(QLatin1Char('.'));
+}
+}  // namespace
+
+BulkInserter::BulkInserter(
+    const QSqlDatabase& database, const QString& table, const QStringList& columns,
+    int batch_size)
+    : database_(database)
+    , query_(database)
+    , columns_(columns.size())
+    , bound_columns_(columns.size())
+    , batch_size_(std::max(batch_size, 1)) {
+    timer_.start();
+    const QSqlDriver* const driver = database_.driver();
+    QStringList names;
+    QStringList placeholders;
+    for (const QString& column : columns) {
+        names.append(driver->escapeIdentifier(column, QSqlDriver::FieldName));
+        placeholders.append(QStringLiteral("?"));
+    }
+    for (std::vector<QVariantList>* lists : {&columns_, &bound_columns_}) {
+        for (QVariantList& values : *lists) {
+            values.reserve(batch_size_);
+        }
+    }
+    if (driver->hasFeature(QSqlDriver::Transactions)) {
+        in_transaction_ = database_.transaction();
+        if (!in_transaction_) {
+            Fail("failed to start transaction", database_.lastError().text());
+            return;
+        }
+    }
+    if (!query_.prepare(QStringLiteral("INSERT INTO %1 (%2) VALUES (%3)")
+                            .arg(
+                                EscapeTableName(*driver, table),
+                                names.join(QStringLiteral(", ")),
+                                placeholders.join(QStringLiteral(", "))))) {
+        Fail("failed to prepare insert", query_.lastError().text());
+    }
+}
+
+BulkInserter::~BulkInserter() {
+    query_.finish();
+    if (in_transaction_) {
+        database_.rollback();
+    }
+}
+
+bool BulkInserter::AddRow(const QVariantList& values) {
+    for (const QVariant& value : values) {
+        AddValue(value);
+    }
+    return EndRow();
+}
+
+void BulkInserter::AddValue(QVariant value) {
+    if (next_column_ < columns_.size()) {
+        columns_[next_column_].append(std::move(value));
+    }
+    ++next_column_;
+}
+
+bool BulkInserter::EndRow() {
+    if (next_column_ > columns_.size()) {
+        Fail(
+            "too many values",
+            QStringLiteral("row has %1 values, expected %2").arg(next_column_).arg(columns_.size()));
+    }
+    for (; next_column_ < columns_.size(); ++next_column_) {
+        columns_[next_column_].append(QVariant());
+    }
+    next_column_ = 0;
+    if (!error_.isEmpty()) {
+        return false;
+    }
+    return ++pending_rows_ < batch_size_ || Flush();
+}
+
+bool BulkInserter::Finish() {
+    if (!Flush()) {
+        return false;
+    }
+    query_.finish();
+    if (in_transaction_) {
+        in_transaction_ = false;
+        if (!database_.commit()) {
+            Fail("failed to commit", database_.lastError().text());
+            database_.rollback();
+            return false;
+        }
+    }
+    return true;
+}
+
+qint64 BulkInserter::RowsInserted() const {
+    return rows_inserted_;
+}
+
+double BulkInserter::RowsPerSecond() const {
+    const qint64 elapsed_ms = timer_.elapsed();
+    return elapsed_ms > 0
+               ? static_cast<double>(rows_inserted_) * 1000.0 / static_cast<double>(elapsed_ms)
+               : 0.0;
+}
+
+QString BulkInserter::ErrorString() const {
+    return error_;
+}
+
+bool BulkInserter::Flush() {
+    if (!error_.isEmpty()) {
+        return false;
+    }
+    if (pending_rows_ == 0) {
+        return true;
+    }
+    for (const QVariantList& values : columns_) {
+        query_.addBindValue(values);
+    }
+    if (!query_.execBatch()) {
+        Fail("failed to insert rows", query_.lastError().text());
+        return false;
+    }
+    rows_inserted_ += pending_rows_;
+    pending_rows_ = 0;
+    // The query holds on to the lists it was given until the next batch is bound in their place.
+    // Clearing them now would detach them from the query into fresh allocations, so the next batch
+    // goes into the lists of the previous one instead: the query has let go of those, and clear()
+    // keeps their reserved buffers.
+    columns_.swap(bound_columns_);
+    for (QVariantList& values : columns_) {
+        values.clear();
+    }
+    return true;
+}
+
+void BulkInserter::Fail(const QString& what, const QString& details) {
+    if (error_.isEmpty()) {
+        error_ = what + ": " + details;
+    }
+}
+}  // namespace outfit::utils
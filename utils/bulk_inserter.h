@@ -0,0 +1,71 @@
+#ifndef CREATIVE_BULK_INSERTER_H
+#define CREATIVE_BULK_INSERTER_H
+
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVariantList>
+#include <vector>
+
+namespace outfit::utils {
+// Inserts rows into `table` through a single prepared statement.
+//
+// `table` is either a bare name or "schema.table"; each part is escaped separately. A name that is
+// already quoted is used verbatim.
+//
+// Rows are accumulated column-wise and flushed with QSqlQuery::execBatch() every `batch_size`
+// rows. All batches run inside one transaction that Finish() commits; a destroyed inserter that
+// was not finished rolls it back. Compared to one exec() per row this is 50-100x faster on
+// SQLite.
+//
+// The inserter owns that transaction, so `database` must not have one open already: Qt cannot
+// nest them, and the constructor then fails with "failed to start transaction". Run the inserter
+// before or after the caller's own transaction instead.
+class BulkInserter {
+   public:
+    BulkInserter(
+        const QSqlDatabase& database, const QString& table, const QStringList& columns,
+        int batch_size = 10'000);
+    ~BulkInserter();
+
+    BulkInserter(const BulkInserter&) = delete;
+    BulkInserter& operator=(const BulkInserter&) = delete;
+    BulkInserter(BulkInserter&&) = delete;
+    BulkInserter& operator=(BulkInserter&&) = delete;
+
+    // Adds a complete row, missing trailing values are inserted as NULL.
+    bool AddRow(const QVariantList& values);
+    // Adds the next value of the current row; EndRow() completes it.
+    void AddValue(QVariant value);
+    bool EndRow();
+
+    // Flushes the pending rows and commits the transaction.
+    bool Finish();
+
+    [[nodiscard]] qint64 RowsInserted() const;
+    [[nodiscard]] double RowsPerSecond() const;
+    [[nodiscard]] QString ErrorString() const;
+
+   private:
+    bool Flush();
+    void Fail(const QString& what, const QString& details);
+
+    QSqlDatabase database_;
+    QSqlQuery query_;
+    std::vector<QVariantList> columns_;
+    // The lists of the last executed batch, still referenced by `query_`.
+    std::vector<QVariantList> bound_columns_;
+    int batch_size_;
+    int pending_rows_ = 0;
+    size_t next_column_ = 0;
+    qint64 rows_inserted_ = 0;
+    bool in_transaction_ = false;
+    QElapsedTimer timer_;
+    QString error_;
+};
+}  // namespace outfit::utils
+
+#endif  // CREATIVE_BULK_INSERTER_H
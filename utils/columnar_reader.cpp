@@ -0,0 +1,338 @@
+#include "columnar_reader.h"
+
+#include <QByteArray>
+#include <QDate>
+#include <QDateTime>
+#include <QMetaType>
+#include <QStringLiteral>
+#include <QTime>
+#include <QtEndian>
+#include <bit>
+#include <cstring>
+#include <utility>
+
+namespace outfit::utils::columnar {
+namespace {
+constexpr char kMagic[] = "OCOL";
+constexpr quint16 kVersion = 1;
+// Header: magic, version, reserved. Trailer: footer size, magic.
+constexpr qint64 kHeaderSize = 8;
+constexpr qint64 kTrailerSize = 8;
+constexpr qint64 kChunkHeaderSize = 9;
+
+// Reads little-endian values from a buffer; every read fails once the buffer is exhausted.
+class Cursor {
+   public:
+    explicit Cursor(const QByteArray& data)
+        : it_(data.constData()), end_(data.constData() + data.size()) {
+    }
+
+    template <typename T>
+    bool Get(T& value) {
+        if (end_ - it_ < static_cast<qsizetype>(sizeof(T))) {
+            return false;
+        }
+        std::memcpy(&value, it_, sizeof(T));
+        value = qFromLittleEndian(value);
+        it_ += sizeof(T);
+        return true;
+    }
+
+    // Returns the next `size` bytes, or nullptr if there are fewer.
+    const char* Take(quint64 size) {
+        if (static_cast<quint64>(end_ - it_) < size) {
+            return nullptr;
+        }
+        const char* const data = it_;
+        it_ += size;
+        return data;
+    }
+
+    bool GetOffsets(quint64 count, std::vector<quint32>& offsets) {
+        if (static_cast<quint64>(end_ - it_) / sizeof(quint32) < count) {
+            return false;
+        }
+        offsets.resize(count);
+        for (quint32& offset : offsets) {
+            Get(offset);
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool AtEnd() const {
+        return it_ == end_;
+    }
+
+   private:
+    const char* it_;
+    const char* end_;
+};
+
+bool TestBit(const char* bitmap, quint32 index) {
+    return ((static_cast<unsigned char>(bitmap[index / 8]) >> (index % 8)) & 1) != 0;
+}
+
+bool IsKnownType(quint8 type) {
+    return type >= static_cast<quint8>(ColumnType::Int64) &&
+           type <= static_cast<quint8>(ColumnType::UInt64);
+}
+
+QMetaType MetaTypeOf(ColumnType type) {
+    switch (type) {
+        case ColumnType::Int64:
+            return QMetaType::fromType<qint64>();
+        case ColumnType::Double:
+            return QMetaType::fromType<double>();
+        case ColumnType::Bool:
+            return QMetaType::fromType<bool>();
+        case ColumnType::String:
+            return QMetaType::fromType<QString>();
+        case ColumnType::Date:
+            return QMetaType::fromType<QDate>();
+        case ColumnType::Time:
+            return QMetaType::fromType<QTime>();
+        case ColumnType::DateTime:
+            return QMetaType::fromType<QDateTime>();
+        case ColumnType::UInt64:
+            return QMetaType::fromType<quint64>();
+    }
+    return QMetaType::fromType<QString>();
+}
+
+QVariant FromInt64(ColumnType type, qint64 value) {
+    switch (type) {
+        case ColumnType::Double:
+            return std::bit_cast<double>(value);
+        case ColumnType::Date:
+            return QDate::fromJulianDay(value);
+        case ColumnType::Time:
+            return QTime::fromMSecsSinceStartOfDay(static_cast<int>(value));
+        case ColumnType::DateTime:
+            return QDateTime::fromMSecsSinceEpoch(value);
+        case ColumnType::UInt64:
+            return static_cast<quint64>(value);
+        default:
+            return value;
+    }
+}
+
+// Decodes UTF-8 strings delimited by `offsets`, which must be ascending and end within `bytes`.
+bool DecodeStrings(
+    const std::vector<quint32>& offsets, Cursor& cursor, std::vector<QString>& strings) {
+    const char* const bytes = cursor.Take(offsets.back());
+    if (bytes == nullptr || offsets.front() != 0) {
+        return false;
+    }
+    strings.clear();
+    strings.reserve(offsets.size() - 1);
+    for (size_t i = 1; i < offsets.size(); ++i) {
+        if (offsets[i] < offsets[i - 1]) {
+            return false;
+        }
+        strings.push_back(
+            QString::fromUtf8(bytes + offsets[i - 1], offsets[i] - offsets[i - 1]));
+    }
+    return true;
+}
+}  // namespace
+
+ColumnarReader::ColumnarReader(QIODevice* device) : device_(device) {
+}
+
+bool ColumnarReader::Open() {
+    columns_.clear();
+    row_groups_.clear();
+    error_.clear();
+    const qint64 size = device_->size();
+    if (size < kHeaderSize + kTrailerSize || !device_->seek(0)) {
+        return Fail(QStringLiteral("not a columnar file"));
+    }
+    const QByteArray header = device_->read(kHeaderSize);
+    Cursor header_cursor(header);
+    quint16 version = 0;
+    if (header.size() != kHeaderSize || std::memcmp(header.constData(), kMagic, 4) != 0 ||
+        !header_cursor.Take(4) || !header_cursor.Get(version)) {
+        return Fail(QStringLiteral("not a columnar file"));
+    }
+    if (version != kVersion) {
+        return Fail(QStringLiteral("unsupported columnar version %1").arg(version));
+    }
+
+    if (!device_->seek(size - kTrailerSize)) {
+        return Fail(device_->errorString());
+    }
+    const QByteArray trailer = device_->read(kTrailerSize);
+    Cursor trailer_cursor(trailer);
+    quint32 footer_size = 0;
+    if (trailer.size() != kTrailerSize || !trailer_cursor.Get(footer_size) ||
+        std::memcmp(trailer.constData() + 4, kMagic, 4) != 0 ||
+        footer_size > size - kHeaderSize - kTrailerSize) {
+        return Fail(QStringLiteral("columnar file is truncated"));
+    }
+    data_end_ = size - kTrailerSize - footer_size;
+    if (!device_->seek(static_cast<qint64>(data_end_))) {
+        return Fail(device_->errorString());
+    }
+    const QByteArray footer = device_->read(footer_size);
+    if (footer.size() != static_cast<qsizetype>(footer_size)) {
+        return Fail(QStringLiteral("columnar file is truncated"));
+    }
+
+    const QString corrupt = QStringLiteral("columnar footer is corrupt");
+    Cursor cursor(footer);
+    quint32 column_count = 0;
+    if (!cursor.Get(column_count)) {
+        return Fail(corrupt);
+    }
+    for (quint32 i = 0; i < column_count; ++i) {
+        quint8 type = 0;
+        quint32 name_size = 0;
+        const char* name = nullptr;
+        if (!cursor.Get(type) || !IsKnownType(type) || !cursor.Get(name_size) ||
+            (name = cursor.Take(name_size)) == nullptr) {
+            return Fail(corrupt);
+        }
+        columns_.push_back(
+            {QString::fromUtf8(name, name_size), static_cast<ColumnType>(type)});
+    }
+    quint32 group_count = 0;
+    if (!cursor.Get(group_count)) {
+        return Fail(corrupt);
+    }
+    for (quint32 i = 0; i < group_count; ++i) {
+        quint64 offset = 0;
+        RowGroup group{0, std::vector<quint64>(column_count)};
+        if (!cursor.Get(offset) || !cursor.Get(group.rows)) {
+            return Fail(corrupt);
+        }
+        for (quint64& chunk_offset : group.chunk_offsets) {
+            if (!cursor.Get(chunk_offset) || chunk_offset < static_cast<quint64>(kHeaderSize) ||
+                chunk_offset > data_end_) {
+                return Fail(corrupt);
+            }
+        }
+        row_groups_.push_back(std::move(group));
+    }
+    if (!cursor.AtEnd()) {
+        return Fail(corrupt);
+    }
+    return true;
+}
+
+const std::vector<ColumnInfo>& ColumnarReader::Columns() const {
+    return columns_;
+}
+
+int ColumnarReader::RowGroupCount() const {
+    return static_cast<int>(row_groups_.size());
+}
+
+quint32 ColumnarReader::RowGroupRows(int group) const {
+    return row_groups_[group].rows;
+}
+
+qint64 ColumnarReader::RowCount() const {
+    qint64 rows = 0;
+    for (const RowGroup& group : row_groups_) {
+        rows += group.rows;
+    }
+    return rows;
+}
+
+bool ColumnarReader::ReadChunk(int group, int column, ColumnChunk& chunk) {
+    const quint32 rows = row_groups_[group].rows;
+    const quint64 offset = row_groups_[group].chunk_offsets[column];
+    const ColumnType type = columns_[column].type;
+    const QString corrupt =
+        QStringLiteral("chunk %1 of row group %2 is corrupt").arg(column).arg(group);
+    if (offset + kChunkHeaderSize > data_end_) {
+        return Fail(corrupt);
+    }
+    if (!device_->seek(static_cast<qint64>(offset))) {
+        return Fail(device_->errorString());
+    }
+    const QByteArray chunk_header = device_->read(kChunkHeaderSize);
+    Cursor header_cursor(chunk_header);
+    quint8 encoding = 0;
+    quint64 payload_size = 0;
+    if (!header_cursor.Get(encoding) || !header_cursor.Get(payload_size) ||
+        encoding > static_cast<quint8>(Encoding::Dictionary) ||
+        payload_size > data_end_ - offset - kChunkHeaderSize) {
+        return Fail(corrupt);
+    }
+    const QByteArray payload = device_->read(static_cast<qint64>(payload_size));
+    if (payload.size() != static_cast<qint64>(payload_size)) {
+        return Fail(corrupt);
+    }
+
+    Cursor cursor(payload);
+    const quint64 bitmap_size = (quint64{rows} + 7) / 8;
+    const char* const validity = cursor.Take(bitmap_size);
+    if (validity == nullptr) {
+        return Fail(corrupt);
+    }
+    chunk.encoding = static_cast<Encoding>(encoding);
+    chunk.values.clear();
+    chunk.values.reserve(rows);
+    const QVariant null(MetaTypeOf(type));
+    const auto append = [&](quint32 row, QVariant value) {
+        chunk.values.append(TestBit(validity, row) ? std::move(value) : null);
+    };
+
+    if (type == ColumnType::Bool) {
+        const char* const bits = cursor.Take(bitmap_size);
+        if (bits == nullptr) {
+            return Fail(corrupt);
+        }
+        for (quint32 row = 0; row < rows; ++row) {
+            append(row, TestBit(bits, row));
+        }
+    } else if (type != ColumnType::String) {
+        for (quint32 row = 0; row < rows; ++row) {
+            qint64 value = 0;
+            if (!cursor.Get(value)) {
+                return Fail(corrupt);
+            }
+            append(row, FromInt64(type, value));
+        }
+    } else if (chunk.encoding == Encoding::Plain) {
+        std::vector<quint32> offsets;
+        std::vector<QString> strings;
+        if (!cursor.GetOffsets(quint64{rows} + 1, offsets) ||
+            !DecodeStrings(offsets, cursor, strings)) {
+            return Fail(corrupt);
+        }
+        for (quint32 row = 0; row < rows; ++row) {
+            append(row, strings[row]);
+        }
+    } else {
+        quint32 entries = 0;
+        std::vector<quint32> offsets;
+        std::vector<QString> dictionary;
+        if (!cursor.Get(entries) || !cursor.GetOffsets(quint64{entries} + 1, offsets) ||
+            !DecodeStrings(offsets, cursor, dictionary)) {
+            return Fail(corrupt);
+        }
+        for (quint32 row = 0; row < rows; ++row) {
+            quint32 index = 0;
+            if (!cursor.Get(index) || index >= entries) {
+                return Fail(corrupt);
+            }
+            append(row, dictionary[index]);
+        }
+    }
+    if (!cursor.AtEnd()) {
+        return Fail(corrupt);
+    }
+    return true;
+}
+
+QString ColumnarReader::ErrorString() const {
+    return error_;
+}
+
+bool ColumnarReader::Fail(const QString& error) {
+    error_ = error;
+    return false;
+}
+}  // namespace outfit::utils::columnar
@@ -0,0 +1,64 @@
+#ifndef CREATIVE_COLUMNAR_READER_H
+#define CREATIVE_COLUMNAR_READER_H
+
+#include "columnar_writer.h"
+
+#include <QIODevice>
+#include <QString>
+#include <QVariantList>
+#include <cstdint>
+#include <vector>
+
+namespace outfit::utils::columnar {
+struct ColumnInfo {
+    QString name;
+    ColumnType type;
+};
+
+// One column of one row group.
+struct ColumnChunk {
+    Encoding encoding = Encoding::Plain;
+    // NULLs are null QVariants of the column's type. Int64 columns hold qint64, UInt64 columns
+    // quint64, Date columns QDate, Time columns QTime and DateTime columns QDateTime in local time.
+    QVariantList values;
+};
+
+// Reads files written by ColumnarWriter.
+//
+// Open() reads only the trailer and the footer; ReadChunk() then seeks to and decodes a single
+// chunk, so a reader touches just the columns it asks for. Every size and offset is checked against
+// the file, so a truncated or corrupt file is an error rather than an out-of-bounds read.
+class ColumnarReader {
+   public:
+    explicit ColumnarReader(QIODevice* device);
+
+    // Reads the footer. Must succeed before anything else is called.
+    bool Open();
+
+    [[nodiscard]] const std::vector<ColumnInfo>& Columns() const;
+    [[nodiscard]] int RowGroupCount() const;
+    [[nodiscard]] quint32 RowGroupRows(int group) const;
+    [[nodiscard]] qint64 RowCount() const;
+
+    bool ReadChunk(int group, int column, ColumnChunk& chunk);
+
+    [[nodiscard]] QString ErrorString() const;
+
+   private:
+    struct RowGroup {
+        quint32 rows;
+        std::vector<quint64> chunk_offsets;
+    };
+
+    bool Fail(const QString& error);
+
+    QIODevice* device_;
+    std::vector<ColumnInfo> columns_;
+    std::vector<RowGroup> row_groups_;
+    // Offset of the footer, the end of the last chunk.
+    quint64 data_end_ = 0;
+    QString error_;
+};
+}  // namespace outfit::utils::columnar
+
+#endif  // CREATIVE_COLUMNAR_READER_H
@@ -0,0 +1,208 @@
+#include "columnar_reader.h"
+
+#include "columnar_writer.h"
+#include "test_util.h"
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QMetaType>
+#include <QSqlDatabase>
+#include <QSqlField>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QString>
+#include <QVariant>
+#include <catch2/catch_test_macros.hpp>
+#include <limits>
+#include <vector>
+
+namespace {
+using outfit::utils::columnar::ColumnarOptions;
+using outfit::utils::columnar::ColumnarReader;
+using outfit::utils::columnar::ColumnarWriter;
+using outfit::utils::columnar::ColumnChunk;
+using outfit::utils::columnar::ColumnType;
+using outfit::utils::columnar::Encoding;
+using outfit::utils::testing::TestApplication;
+
+constexpr auto kConnection = "columnar_reader_test";
+constexpr int kRows = 1000;
+constexpr const char* kCities[] = {"Москва", "Berlin", ""};
+
+// Writes t (id, score, flag, city, note) with `options`: score and note have NULLs, city has three
+// distinct values and note one per row, so a row group holds both string encodings.
+QByteArray WriteTable(const ColumnarOptions& options) {
+    TestApplication();
+    QByteArray file;
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", kConnection);
+        database.setDatabaseName(":memory:");
+        REQUIRE(database.open());
+        QSqlQuery query(database);
+        REQUIRE(query.exec(
+            "CREATE TABLE t (id INTEGER, score REAL, flag BOOLEAN, city TEXT, note TEXT)"));
+        REQUIRE(database.transaction());
+        REQUIRE(query.prepare("INSERT INTO t VALUES (?, ?, ?, ?, ?)"));
+        for (int id = 0; id < kRows; ++id) {
+            query.addBindValue(id);
+            query.addBindValue(id % 7 == 0 ? QVariant() : QVariant(id * 0.5));
+            query.addBindValue(id % 3 == 0);
+            query.addBindValue(QString::fromUtf8(kCities[id % 3]));
+            query.addBindValue(id % 5 == 0 ? QVariant() : QVariant(QString("note %1").arg(id)));
+            REQUIRE(query.exec());
+        }
+        REQUIRE(database.commit());
+
+        query.setForwardOnly(true);
+        REQUIRE(query.exec("SELECT id, score, flag, city, note FROM t ORDER BY id"));
+        QBuffer buffer(&file);
+        REQUIRE(buffer.open(QBuffer::WriteOnly));
+        ColumnarWriter writer(&buffer, query.record(), options);
+        while (query.next()) {
+            REQUIRE(writer.AppendRow(query));
+        }
+        REQUIRE(writer.Finish());
+        CHECK(writer.RowsWritten() == kRows);
+    }
+    QSqlDatabase::removeDatabase(kConnection);
+    return file;
+}
+
+// Reads every chunk back and checks it against the rows WriteTable() inserted.
+std::vector<Encoding> CheckRoundTrip(QByteArray file, int row_groups) {
+    QBuffer buffer(&file);
+    REQUIRE(buffer.open(QBuffer::ReadOnly));
+    ColumnarReader reader(&buffer);
+    const bool opened = reader.Open();
+    INFO(reader.ErrorString().toStdString());
+    REQUIRE(opened);
+    REQUIRE(reader.Columns().size() == 5);
+    CHECK(reader.Columns()[0].name == "id");
+    CHECK(reader.Columns()[0].type == ColumnType::Int64);
+    CHECK(reader.Columns()[1].type == ColumnType::Double);
+    CHECK(reader.Columns()[2].type == ColumnType::Bool);
+    CHECK(reader.Columns()[3].type == ColumnType::String);
+    CHECK(reader.RowCount() == kRows);
+    REQUIRE(reader.RowGroupCount() == row_groups);
+
+    std::vector<Encoding> city_encodings;
+    int first_row = 0;
+    for (int group = 0; group < reader.RowGroupCount(); ++group) {
+        std::vector<ColumnChunk> chunks(reader.Columns().size());
+        for (int column = 0; column < std::ssize(chunks); ++column) {
+            REQUIRE(reader.ReadChunk(group, column, chunks[column]));
+            REQUIRE(
+                chunks[column].values.size() ==
+                static_cast<qsizetype>(reader.RowGroupRows(group)));
+        }
+        city_encodings.push_back(chunks[3].encoding);
+        for (int row = 0; row < static_cast<int>(reader.RowGroupRows(group)); ++row) {
+            const int id = first_row + row;
+            CHECK(chunks[0].values[row].toLongLong() == id);
+            if (id % 7 == 0) {
+                CHECK(chunks[1].values[row].isNull());
+            } else {
+                CHECK(chunks[1].values[row].toDouble() == id * 0.5);
+            }
+            CHECK(chunks[2].values[row].toBool() == (id % 3 == 0));
+            CHECK_FALSE(chunks[3].values[row].isNull());
+            CHECK(chunks[3].values[row].toString() == QString::fromUtf8(kCities[id % 3]));
+            if (id % 5 == 0) {
+                CHECK(chunks[4].values[row].isNull());
+            } else {
+                CHECK(chunks[4].values[row].toString() == QString("note %1").arg(id));
+            }
+        }
+        first_row += static_cast<int>(reader.RowGroupRows(group));
+    }
+    return city_encodings;
+}
+}  // namespace
+
+TEST_CASE("ColumnarReader reads back NULLs and dictionary strings over several row groups") {
+    ColumnarOptions options;
+    options.row_group_rows = 300;
+    const std::vector<Encoding> encodings = CheckRoundTrip(WriteTable(options), 4);
+    for (const Encoding encoding : encodings) {
+        CHECK(encoding == Encoding::Dictionary);
+    }
+}
+
+TEST_CASE("ColumnarReader reads back strings whose dictionary overflowed") {
+    ColumnarOptions options;
+    options.row_group_rows = 400;
+    options.max_dictionary_entries = 2;
+    const std::vector<Encoding> encodings = CheckRoundTrip(WriteTable(options), 3);
+    for (const Encoding encoding : encodings) {
+        CHECK(encoding == Encoding::Plain);
+    }
+}
+
+TEST_CASE("ColumnarReader reads back unsigned values above INT64_MAX") {
+    TestApplication();
+    constexpr quint64 kMax = std::numeric_limits<quint64>::max();
+    constexpr quint64 kAboveInt64 = quint64{1} << 63;
+    QByteArray file;
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", kConnection);
+        database.setDatabaseName(":memory:");
+        REQUIRE(database.open());
+        QSqlQuery query(database);
+        // SQLite has no unsigned 64-bit integers, so the large values come in as text.
+        REQUIRE(query.exec("CREATE TABLE u (id INTEGER, v)"));
+        REQUIRE(query.exec(
+            QString("INSERT INTO u VALUES (1, '%1'), (2, '%2'), (3, 7), (4, NULL)")
+                .arg(kMax)
+                .arg(kAboveInt64)));
+        query.setForwardOnly(true);
+        REQUIRE(query.exec("SELECT v FROM u ORDER BY id"));
+        // The column type comes from the record, as it would for a driver with unsigned columns.
+        QSqlRecord record;
+        record.append(QSqlField("v", QMetaType::fromType<quint64>()));
+        QBuffer buffer(&file);
+        REQUIRE(buffer.open(QBuffer::WriteOnly));
+        ColumnarWriter writer(&buffer, record);
+        while (query.next()) {
+            REQUIRE(writer.AppendRow(query));
+        }
+        REQUIRE(writer.Finish());
+    }
+    QSqlDatabase::removeDatabase(kConnection);
+
+    QBuffer buffer(&file);
+    REQUIRE(buffer.open(QBuffer::ReadOnly));
+    ColumnarReader reader(&buffer);
+    REQUIRE(reader.Open());
+    REQUIRE(reader.Columns().size() == 1);
+    CHECK(reader.Columns()[0].type == ColumnType::UInt64);
+    ColumnChunk chunk;
+    REQUIRE(reader.ReadChunk(0, 0, chunk));
+    REQUIRE(chunk.values.size() == 4);
+    CHECK(chunk.values[0].metaType() == QMetaType::fromType<quint64>());
+    CHECK(chunk.values[0].toULongLong() == kMax);
+    CHECK(chunk.values[1].toULongLong() == kAboveInt64);
+    CHECK(chunk.values[2].toULongLong() == 7);
+    CHECK(chunk.values[3].isNull());
+}
+
+TEST_CASE("ColumnarReader rejects truncated files") {
+    QByteArray file = WriteTable({});
+    for (const qsizetype size : {qsizetype{0}, qsizetype{12}, file.size() - 1}) {
+        QByteArray truncated = file.left(size);
+        QBuffer buffer(&truncated);
+        REQUIRE(buffer.open(QBuffer::ReadOnly));
+        ColumnarReader reader(&buffer);
+        CHECK_FALSE(reader.Open());
+        CHECK_FALSE(reader.ErrorString().isEmpty());
+    }
+
+    // A corrupt chunk header is only found when the chunk is read, not when the footer is.
+    QBuffer buffer(&file);
+    REQUIRE(buffer.open(QBuffer::ReadOnly));
+    ColumnarReader reader(&buffer);
+    REQUIRE(reader.Open());
+    // The high byte of the first chunk's payload size.
+    file[8 + 8] = 0x7F;
+    ColumnChunk chunk;
+    CHECK_FALSE(reader.ReadChunk(0, 0, chunk));
+}
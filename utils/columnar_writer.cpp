@@ -0,0 +1,325 @@
+#include "columnar_writer.h"
+
+#include "csv_format.h"
+
+#include <QDate>
+#include <QDateTime>
+#include <QFile>
+#include <QSqlError>
+#include <QSqlField>
+#include <QStringLiteral>
+#include <QTime>
+#include <QtEndian>
+#include <algorithm>
+#include <bit>
+
+namespace outfit::utils::columnar {
+namespace {
+constexpr char kMagic[] = "OCOL";
+constexpr quint16 kVersion = 1;
+
+template <typename T>
+void Put(QByteArray& out, T value) {
+    const T little = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char*>(&little), sizeof(T));
+}
+
+void Put(QByteArray& out, const std::vector<quint32>& values) {
+    for (const quint32 value : values) {
+        Put(out, value);
+    }
+}
+
+void SetBit(QByteArray& bitmap, quint32 index, bool value) {
+    if (index % 8 == 0) {
+        bitmap.append('\0');
+    }
+    if (value) {
+        bitmap[index / 8] = static_cast<char>(bitmap[index / 8] | (1 << (index % 8)));
+    }
+}
+
+ColumnType TypeOf(QMetaType type) {
+    using Kind = csv::CellFormatter::Kind;
+    switch (csv::CellFormatter::KindOf(type)) {
+        case Kind::Bool:
+            return ColumnType::Bool;
+        case Kind::Int:
+            return ColumnType::Int64;
+        case Kind::UInt:
+            return ColumnType::UInt64;
+        case Kind::Float:
+        case Kind::Double:
+            return ColumnType::Double;
+        case Kind::Date:
+            return ColumnType::Date;
+        case Kind::Time:
+            return ColumnType::Time;
+        case Kind::DateTime:
+            return ColumnType::DateTime;
+        case Kind::String:
+        case Kind::Other:
+            return ColumnType::String;
+    }
+    return ColumnType::String;
+}
+
+// Converts `value` to the 64-bit representation of `type`; false if it has none. UInt64 values
+// keep their bits, so those above INT64_MAX come out negative here and are read back unsigned.
+bool ToInt64(ColumnType type, const QVariant& value, qint64& out) {
+    bool ok = true;
+    switch (type) {
+        case ColumnType::Int64:
+            out = value.toLongLong(&ok);
+            return ok;
+        case ColumnType::UInt64:
+            out = static_cast<qint64>(value.toULongLong(&ok));
+            return ok;
+        case ColumnType::Date: {
+            const QDate date = value.toDate();
+            out = date.toJulianDay();
+            return date.isValid();
+        }
+        case ColumnType::Time: {
+            const QTime time = value.toTime();
+            out = time.msecsSinceStartOfDay();
+            return time.isValid();
+        }
+        case ColumnType::DateTime: {
+            const QDateTime date_time = value.toDateTime();
+            out = date_time.toMSecsSinceEpoch();
+            return date_time.isValid();
+        }
+        default:
+            return false;
+    }
+}
+}  // namespace
+
+ColumnarWriter::ColumnarWriter(QIODevice* device, const QSqlRecord& record, ColumnarOptions options)
+    : device_(device), options_(options), columns_(record.count()) {
+    options_.row_group_rows = std::max(options_.row_group_rows, 1);
+    for (int i = 0; i < record.count(); ++i) {
+        columns_[i].name = record.fieldName(i);
+        columns_[i].type = TypeOf(record.field(i).metaType());
+        ResetColumn(columns_[i]);
+    }
+    QByteArray header(kMagic, 4);
+    Put(header, kVersion);
+    Put(header, quint16{0});
+    Write(header);
+}
+
+bool ColumnarWriter::AppendRow(const QSqlQuery& query) {
+    if (!error_.isEmpty()) {
+        return false;
+    }
+    for (int i = 0; i < std::ssize(columns_); ++i) {
+        AppendValue(columns_[i], query.value(i));
+    }
+    ++rows_written_;
+    return ++group_rows_ < static_cast<quint32>(options_.row_group_rows) || FlushRowGroup();
+}
+
+bool ColumnarWriter::Finish() {
+    if (!FlushRowGroup()) {
+        return false;
+    }
+    QByteArray footer;
+    Put(footer, static_cast<quint32>(columns_.size()));
+    for (const Column& column : columns_) {
+        const QByteArray name = column.name.toUtf8();
+        Put(footer, static_cast<quint8>(column.type));
+        Put(footer, static_cast<quint32>(name.size()));
+        footer.append(name);
+    }
+    Put(footer, static_cast<quint32>(row_groups_.size()));
+    for (const RowGroup& group : row_groups_) {
+        Put(footer, group.offset);
+        Put(footer, group.rows);
+        for (const quint64 offset : group.chunk_offsets) {
+            Put(footer, offset);
+        }
+    }
+    Put(footer, static_cast<quint32>(footer.size()));
+    footer.append(kMagic, 4);
+    return Write(footer);
+}
+
+qint64 ColumnarWriter::RowsWritten() const {
+    return rows_written_;
+}
+
+QString ColumnarWriter::ErrorString() const {
+    return error_;
+}
+
+void ColumnarWriter::AppendValue(Column& column, const QVariant& value) {
+    const quint32 row = group_rows_;
+    if (value.isNull()) {
+        SetBit(column.validity, row, false);
+        if (column.type == ColumnType::Bool) {
+            SetBit(column.values, row, false);
+        } else if (column.type == ColumnType::String) {
+            AppendString(column, {});
+        } else {
+            Put(column.values, quint64{0});
+        }
+        return;
+    }
+    bool valid = true;
+    switch (column.type) {
+        case ColumnType::Bool:
+            SetBit(column.values, row, value.toBool());
+            break;
+        case ColumnType::Double: {
+            const double number = value.toDouble(&valid);
+            Put(column.values, std::bit_cast<quint64>(number));
+            break;
+        }
+        case ColumnType::String:
+            AppendString(column, value.toString());
+            break;
+        default: {
+            qint64 number = 0;
+            valid = ToInt64(column.type, value, number);
+            Put(column.values, valid ? number : qint64{0});
+            break;
+        }
+    }
+    // Values that do not convert to the column type (SQLite is dynamically typed) become NULL.
+    SetBit(column.validity, row, valid);
+}
+
+void ColumnarWriter::AppendString(Column& column, const QString& text) {
+    const QByteArray utf8 = text.toUtf8();
+    column.bytes.append(utf8);
+    column.offsets.push_back(static_cast<quint32>(column.bytes.size()));
+    if (column.dictionary_full) {
+        return;
+    }
+    const auto it = column.dictionary.constFind(text);
+    if (it != column.dictionary.cend()) {
+        column.indices.push_back(*it);
+        return;
+    }
+    if (column.dictionary.size() >= options_.max_dictionary_entries) {
+        // Too many distinct values for a dictionary to pay off; stay plain for this row group.
+        column.dictionary_full = true;
+        column.dictionary.clear();
+        column.dictionary_offsets.clear();
+        column.dictionary_bytes.clear();
+        column.indices.clear();
+        return;
+    }
+    const auto index = static_cast<quint32>(column.dictionary.size());
+    column.dictionary.insert(text, index);
+    column.dictionary_bytes.append(utf8);
+    column.dictionary_offsets.push_back(static_cast<quint32>(column.dictionary_bytes.size()));
+    column.indices.push_back(index);
+}
+
+bool ColumnarWriter::FlushRowGroup() {
+    if (!error_.isEmpty()) {
+        return false;
+    }
+    if (group_rows_ == 0) {
+        return true;
+    }
+    RowGroup group{offset_, group_rows_, {}};
+    group.chunk_offsets.reserve(columns_.size());
+    for (Column& column : columns_) {
+        Encoding encoding = Encoding::Plain;
+        const QByteArray payload = EncodeChunk(column, encoding);
+        QByteArray chunk_header;
+        Put(chunk_header, static_cast<quint8>(encoding));
+        Put(chunk_header, static_cast<quint64>(payload.size()));
+        group.chunk_offsets.push_back(offset_);
+        if (!Write(chunk_header) || !Write(payload)) {
+            return false;
+        }
+        ResetColumn(column);
+    }
+    row_groups_.push_back(std::move(group));
+    group_rows_ = 0;
+    return true;
+}
+
+QByteArray ColumnarWriter::EncodeChunk(Column& column, Encoding& encoding) const {
+    QByteArray payload = column.validity;
+    if (column.type != ColumnType::String) {
+        payload.append(column.values);
+        return payload;
+    }
+    const qsizetype plain_size =
+        static_cast<qsizetype>(column.offsets.size() * sizeof(quint32)) + column.bytes.size();
+    const qsizetype dictionary_size =
+        static_cast<qsizetype>(
+            (1 + column.dictionary_offsets.size() + column.indices.size()) * sizeof(quint32)) +
+        column.dictionary_bytes.size();
+    if (!column.dictionary_full && dictionary_size < plain_size) {
+        encoding = Encoding::Dictionary;
+        payload.reserve(payload.size() + dictionary_size);
+        Put(payload, static_cast<quint32>(column.dictionary.size()));
+        Put(payload, column.dictionary_offsets);
+        payload.append(column.dictionary_bytes);
+        Put(payload, column.indices);
+    } else {
+        encoding = Encoding::Plain;
+        payload.reserve(payload.size() + plain_size);
+        Put(payload, column.offsets);
+        payload.append(column.bytes);
+    }
+    return payload;
+}
+
+void ColumnarWriter::ResetColumn(Column& column) {
+    column.validity.clear();
+    column.values.clear();
+    column.bytes.clear();
+    column.offsets.assign(1, 0);
+    column.dictionary.clear();
+    column.dictionary_offsets.assign(1, 0);
+    column.dictionary_bytes.clear();
+    column.indices.clear();
+    column.dictionary_full = false;
+}
+
+bool ColumnarWriter::Write(const QByteArray& data) {
+    if (!error_.isEmpty()) {
+        return false;
+    }
+    if (device_->write(data) != data.size()) {
+        error_ = device_->errorString();
+        return false;
+    }
+    offset_ += data.size();
+    return true;
+}
+
+bool ExportColumnar(
+    QSqlQuery& query, const QString& file_name, QString& error, ColumnarOptions options) {
+    query.setForwardOnly(true);
+    if (!query.exec()) {
+        error = query.lastError().text();
+        return false;
+    }
+    QFile file(file_name);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    ColumnarWriter writer(&file, query.record(), options);
+    while (query.next()) {
+        if (!writer.AppendRow(query)) {
+            break;
+        }
+    }
+    if (!writer.Finish() || !file.flush()) {
+        error = writer.ErrorString().isEmpty() ? file.errorString() : writer.ErrorString();
+        file.remove();
+        return false;
+    }
+    return true;
+}
+}  // namespace outfit::utils::columnar
@@ -0,0 +1,114 @@
+#ifndef CREATIVE_COLUMNAR_WRITER_H
+#define CREATIVE_COLUMNAR_WRITER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QIODevice>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QString>
+#include <QVariant>
+#include <cstdint>
+#include <vector>
+
+// Columnar binary export of query results.
+//
+// File layout, all integers little endian:
+//
+//   header      "OCOL" u16 version u16 reserved
+//   row group*  one chunk per column: u8 encoding, u64 payload size, payload
+//   footer      u32 column count, per column { u8 type, u32 name size, UTF-8 name }
+//               u32 row group count, per group { u64 offset, u32 rows, u64 chunk offset[columns] }
+//   trailer     u32 footer size, "OCOL"
+//
+// A chunk payload starts with a validity bitmap ((rows + 7) / 8 bytes, LSB first, set = not NULL)
+// followed by the values:
+//
+//   Int64, UInt64, Double, Date, Time,    rows x 8 bytes; Date is the Julian day, Time the msecs
+//   DateTime                              since midnight, DateTime the msecs since the epoch
+//   Bool                                  bitmap like the validity bitmap
+//   String, plain encoding                (rows + 1) x u32 offsets, UTF-8 bytes
+//   String, dictionary encoding           u32 entries, (entries + 1) x u32 offsets, UTF-8 bytes,
+//                                         rows x u32 indices
+//
+// Readers seek to the trailer, read the footer and then only the chunks of the columns they need;
+// ColumnarReader does exactly that.
+namespace outfit::utils::columnar {
+enum class ColumnType : uint8_t {
+    Int64 = 1,
+    Double = 2,
+    Bool = 3,
+    String = 4,
+    Date = 5,
+    Time = 6,
+    DateTime = 7,
+    UInt64 = 8,
+};
+
+enum class Encoding : uint8_t { Plain = 0, Dictionary = 1 };
+
+struct ColumnarOptions {
+    // Rows buffered per column before a row group is written.
+    int row_group_rows = 64 * 1024;
+    // String columns with more distinct values per row group are stored plain.
+    int max_dictionary_entries = 64 * 1024;
+};
+
+class ColumnarWriter {
+   public:
+    ColumnarWriter(QIODevice* device, const QSqlRecord& record, ColumnarOptions options = {});
+
+    // Appends the current row of `query`.
+    bool AppendRow(const QSqlQuery& query);
+    // Writes the last row group and the footer.
+    bool Finish();
+
+    [[nodiscard]] qint64 RowsWritten() const;
+    [[nodiscard]] QString ErrorString() const;
+
+   private:
+    struct Column {
+        QString name;
+        ColumnType type;
+        QByteArray validity;
+        // Int64-like, UInt64 and Double values, or the Bool bitmap.
+        QByteArray values;
+        // String values, kept plain and dictionary encoded until the dictionary overflows.
+        std::vector<quint32> offsets;
+        QByteArray bytes;
+        QHash<QString, quint32> dictionary;
+        std::vector<quint32> dictionary_offsets;
+        QByteArray dictionary_bytes;
+        std::vector<quint32> indices;
+        bool dictionary_full = false;
+    };
+
+    struct RowGroup {
+        quint64 offset;
+        quint32 rows;
+        std::vector<quint64> chunk_offsets;
+    };
+
+    void AppendValue(Column& column, const QVariant& value);
+    void AppendString(Column& column, const QString& text);
+    bool FlushRowGroup();
+    QByteArray EncodeChunk(Column& column, Encoding& encoding) const;
+    void ResetColumn(Column& column);
+    bool Write(const QByteArray& data);
+
+    QIODevice* device_;
+    ColumnarOptions options_;
+    std::vector<Column> columns_;
+    std::vector<RowGroup> row_groups_;
+    quint32 group_rows_ = 0;
+    qint64 rows_written_ = 0;
+    quint64 offset_ = 0;
+    QString error_;
+};
+
+// Executes the prepared `query` and writes its result to `file_name` in the format above.
+bool ExportColumnar(
+    QSqlQuery& query, const QString& file_name, QString& error, ColumnarOptions options = {});
+}  // namespace outfit::utils::columnar
+
+#endif  // CREATIVE_COLUMNAR_WRITER_H
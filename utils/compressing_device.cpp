@@ -0,0 +1,280 @@
+#include "compressing_device.h"
+
+#include <QMutexLocker>
+#include <algorithm>
+#include <climits>
+#include <utility>
+#include <zlib.h>
+#include <zstd.h>
+
+namespace outfit::utils::csv {
+class CompressingDevice::Encoder {
+   public:
+    Encoder() = default;
+    virtual ~Encoder() = default;
+
+    Encoder(const Encoder&) = delete;
+    Encoder& operator=(const Encoder&) = delete;
+    Encoder(Encoder&&) = delete;
+    Encoder& operator=(Encoder&&) = delete;
+
+    // Compresses `len` bytes and appends the output to `out`; `finish` ends the stream.
+    virtual bool Encode(const char* data, qint64 len, bool finish, QByteArray& out) = 0;
+};
+
+namespace {
+constexpr qsizetype kGzipChunk = qsizetype{64} << 10;
+
+class GzipEncoder : public CompressingDevice::Encoder {
+   public:
+    explicit GzipEncoder(int level) {
+        // 15 + 16 window bits selects the gzip wrapper instead of raw zlib.
+        ok_ = deflateInit2(
+                  &stream_, level == 0 ? Z_DEFAULT_COMPRESSION : level, Z_DEFLATED, 15 + 16, 8,
+                  Z_DEFAULT_STRATEGY) == Z_OK;
+    }
+
+    ~GzipEncoder() override {
+        if (ok_) {
+            deflateEnd(&stream_);
+        }
+    }
+
+    GzipEncoder(const GzipEncoder&) = delete;
+    GzipEncoder& operator=(const GzipEncoder&) = delete;
+    GzipEncoder(GzipEncoder&&) = delete;
+    GzipEncoder& operator=(GzipEncoder&&) = delete;
+
+    bool Encode(const char* data, qint64 len, bool finish, QByteArray& out) override {
+        if (!ok_) {
+            return false;
+        }
+        do {
+            // avail_in is 32 bits wide.
+            const auto slice = static_cast<uInt>(std::min<qint64>(len, UINT_MAX));
+            // deflate() never writes through next_in.
+            stream_.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(data));
+            stream_.avail_in = slice;
+            data += slice;
+            len -= slice;
+            const int flush = finish && len == 0 ? Z_FINISH : Z_NO_FLUSH;
+            do {
+                const qsizetype size = out.size();
+                out.resize(size + kGzipChunk);
+                stream_.next_out = reinterpret_cast<Bytef*>(out.data() + size);
+                stream_.avail_out = static_cast<uInt>(kGzipChunk);
+                const int result = deflate(&stream_, flush);
+                out.resize(size + kGzipChunk - stream_.avail_out);
+                if (result == Z_STREAM_ERROR) {
+                    return false;
+                }
+            } while (stream_.avail_out == 0);
+        } while (len > 0);
+        return true;
+    }
+
+   private:
+    z_stream stream_{};
+    bool ok_ = false;
+};
+
+class ZstdEncoder : public CompressingDevice::Encoder {
+   public:
+    explicit ZstdEncoder(int level) : context_(ZSTD_createCCtx()) {
+        ok_ = context_ != nullptr &&
+              ZSTD_isError(ZSTD_CCtx_setParameter(
+                  context_, ZSTD_c_compressionLevel, level == 0 ? ZSTD_CLEVEL_DEFAULT : level)) ==
+                  0;
+    }
+
+    ~ZstdEncoder() override {
+        ZSTD_freeCCtx(context_);
+    }
+
+    ZstdEncoder(const ZstdEncoder&) = delete;
+    ZstdEncoder& operator=(const ZstdEncoder&) = delete;
+    ZstdEncoder(ZstdEncoder&&) = delete;
+    ZstdEncoder& operator=(ZstdEncoder&&) = delete;
+
+    bool Encode(const char* data, qint64 len, bool finish, QByteArray& out) override {
+        if (!ok_) {
+            return false;
+        }
+        ZSTD_inBuffer input{data, static_cast<size_t>(len), 0};
+        const ZSTD_EndDirective mode = finish ? ZSTD_e_end : ZSTD_e_continue;
+        const size_t chunk = ZSTD_CStreamOutSize();
+        while (true) {
+            const qsizetype size = out.size();
+            out.resize(size + static_cast<qsizetype>(chunk));
+            ZSTD_outBuffer output{out.data() + size, chunk, 0};
+            const size_t remaining = ZSTD_compressStream2(context_, &output, &input, mode);
+            out.resize(size + static_cast<qsizetype>(output.pos));
+            if (ZSTD_isError(remaining) != 0) {
+                return false;
+            }
+            if (finish ? remaining == 0 : input.pos == input.size) {
+                return true;
+            }
+        }
+    }
+
+   private:
+    ZSTD_CCtx* context_;
+    bool ok_ = false;
+};
+}  // namespace
+
+CompressingDevice::CompressingDevice(QIODevice* target, const CompressionOptions& options)
+    : target_(target), options_(options) {
+    switch (options_.codec) {
+        case Codec::None:
+            break;
+        case Codec::Gzip:
+            encoder_ = std::make_unique<GzipEncoder>(options_.level);
+            break;
+        case Codec::Zstd:
+            encoder_ = std::make_unique<ZstdEncoder>(options_.level);
+            break;
+    }
+}
+
+CompressingDevice::~CompressingDevice() {
+    Finish();
+}
+
+bool CompressingDevice::open(OpenMode mode) {
+    if ((mode & ReadOnly) != 0) {
+        setErrorString("compressing device is write-only");
+        return false;
+    }
+    if (options_.threaded && !thread_) {
+        thread_.reset(QThread::create([this] { RunCompressor(); }));
+        thread_->start();
+    }
+    return QIODevice::open(mode | Unbuffered);
+}
+
+void CompressingDevice::close() {
+    Finish();
+    QIODevice::close();
+}
+
+bool CompressingDevice::isSequential() const {
+    return true;
+}
+
+bool CompressingDevice::Finish() {
+    if (finished_ || !isOpen()) {
+        return !failed_;
+    }
+    finished_ = true;
+    if (thread_) {
+        {
+            const QMutexLocker locker(&mutex_);
+            closing_ = true;
+            not_empty_.wakeAll();
+        }
+        // The compressor drains the queue and ends the stream before it exits.
+        thread_->wait();
+    } else {
+        Compress(nullptr, 0, true);
+    }
+    if (failed_) {
+        const QMutexLocker locker(&mutex_);
+        setErrorString(error_);
+    }
+    return !failed_;
+}
+
+qint64 CompressingDevice::CompressedBytes() const {
+    return compressed_bytes_;
+}
+
+QString CompressingDevice::Suffix(Codec codec) {
+    switch (codec) {
+        case Codec::None:
+            return {};
+        case Codec::Gzip:
+            return QStringLiteral(".gz");
+        case Codec::Zstd:
+            return QStringLiteral(".zst");
+    }
+    return {};
+}
+
+qint64 CompressingDevice::readData(char* /*data*/, qint64 /*maxlen*/) {
+    return -1;
+}
+
+qint64 CompressingDevice::writeData(const char* data, qint64 len) {
+    if (!failed_ && !finished_) {
+        if (!thread_) {
+            return Compress(data, len, false) ? len : -1;
+        }
+        QMutexLocker locker(&mutex_);
+        while (std::ssize(queue_) >= std::max(options_.queue_blocks, 1) && !failed_) {
+            not_full_.wait(&mutex_);
+        }
+        if (!failed_) {
+            queue_.emplace_back(data, len);
+            not_empty_.wakeOne();
+            return len;
+        }
+    }
+    const QMutexLocker locker(&mutex_);
+    setErrorString(error_.isEmpty() ? QStringLiteral("compressed stream is finished") : error_);
+    return -1;
+}
+
+bool CompressingDevice::Compress(const char* data, qint64 len, bool finish) {
+    if (failed_ || (len == 0 && !finish)) {
+        return !failed_;
+    }
+    const char* block = data;
+    qint64 size = len;
+    if (encoder_) {
+        output_.resize(0);
+        if (!encoder_->Encode(data, len, finish, output_)) {
+            SetError("compression failed");
+            return false;
+        }
+        block = output_.constData();
+        size = output_.size();
+    }
+    if (size > 0 && target_->write(block, size) != size) {
+        SetError(target_->errorString());
+        return false;
+    }
+    compressed_bytes_ += size;
+    return true;
+}
+
+void CompressingDevice::RunCompressor() {
+    while (true) {
+        QByteArray block;
+        {
+            QMutexLocker locker(&mutex_);
+            while (queue_.empty() && !closing_) {
+                not_empty_.wait(&mutex_);
+            }
+            if (queue_.empty()) {
+                break;
+            }
+            block = std::move(queue_.front());
+            queue_.pop_front();
+            not_full_.wakeOne();
+        }
+        Compress(block.constData(), block.size(), false);
+    }
+    Compress(nullptr, 0, true);
+}
+
+void CompressingDevice::SetError(const QString& error) {
+    const QMutexLocker locker(&mutex_);
+    if (error_.isEmpty()) {
+        error_ = error;
+    }
+    failed_ = true;
+    not_full_.wakeAll();
+}
+}  // namespace outfit::utils::csv
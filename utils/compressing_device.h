@@ -0,0 +1,88 @@
+#ifndef CREATIVE_COMPRESSING_DEVICE_H
+#define CREATIVE_COMPRESSING_DEVICE_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+namespace outfit::utils::csv {
+enum class Codec : uint8_t { None, Gzip, Zstd };
+
+struct CompressionOptions {
+    Codec codec = Codec::None;
+    // Codec specific level, 0 selects the codec default.
+    int level = 0;
+    // Compresses on a separate thread fed through a bounded queue, so that producing the data and
+    // compressing it overlap.
+    bool threaded = false;
+    // Blocks the queue holds before writers have to wait for the compressor.
+    int queue_blocks = 4;
+};
+
+// Write-only device that stream-compresses everything written to it into `target`.
+//
+// Finish() must be called (close() does it too) to write the end of the compressed stream. With
+// `threaded` set, write() only copies the data into the queue; compression and write errors are
+// reported by the next write() or by Finish().
+class CompressingDevice : public QIODevice {
+    Q_OBJECT
+
+   public:
+    class Encoder;
+
+    CompressingDevice(QIODevice* target, const CompressionOptions& options);
+    ~CompressingDevice() override;
+
+    CompressingDevice(const CompressingDevice&) = delete;
+    CompressingDevice& operator=(const CompressingDevice&) = delete;
+    CompressingDevice(CompressingDevice&&) = delete;
+    CompressingDevice& operator=(CompressingDevice&&) = delete;
+
+    bool open(OpenMode mode) override;
+    void close() override;
+    [[nodiscard]] bool isSequential() const override;
+
+    // Flushes the compressor and writes the stream trailer. Returns false on any error.
+    bool Finish();
+    // Bytes written to `target` so far.
+    [[nodiscard]] qint64 CompressedBytes() const;
+
+    // File name suffix for `codec`, e.g. ".gz".
+    [[nodiscard]] static QString Suffix(Codec codec);
+
+   protected:
+    qint64 readData(char* data, qint64 maxlen) override;
+    qint64 writeData(const char* data, qint64 len) override;
+
+   private:
+    bool Compress(const char* data, qint64 len, bool finish);
+    void RunCompressor();
+    void SetError(const QString& error);
+
+    QIODevice* target_;
+    CompressionOptions options_;
+    std::unique_ptr<Encoder> encoder_;
+    QByteArray output_;
+    std::atomic<qint64> compressed_bytes_ = 0;
+    bool finished_ = false;
+
+    // Threaded mode: blocks handed over to the compressor thread.
+    std::unique_ptr<QThread> thread_;
+    QMutex mutex_;
+    QWaitCondition not_empty_;
+    QWaitCondition not_full_;
+    std::deque<QByteArray> queue_;
+    bool closing_ = false;
+    std::atomic<bool> failed_ = false;
+    QString error_;
+};
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_COMPRESSING_DEVICE_H
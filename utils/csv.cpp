@@ -4,54 +4,57 @@
 
 #include "csv.h"
 
-#include <QFile>
 #include <QFileDialog>
-#include <QLatin1Char>
 #include <QMessageBox>
-#include <QSqlQuery>
-#include <QSqlRecord>
 #include <QString>
-#include <QStringLiteral>
-#include <QTextStream>
-#include <QtCore/qstringconverter_base.h>
 
-QString outfit::utils::csv::EscapeCSV(QString unexc) {
-    if (!unexc.contains(QLatin1Char(','))) {
-        return unexc;
+namespace {
+void ShowError(const QString& error) {
+    QMessageBox msg;
+    msg.setText(error);
+    msg.exec();
+}
+}  // namespace
+
+void outfit::utils::csv::SaveQuery(
+    const QString& header, QSqlQuery& query, const CompressionOptions& compression) {
+    const QString suffix = CompressingDevice::Suffix(compression.codec);
+    const QString file_name = QFileDialog::getSaveFileName(
+        nullptr, "export.csv" + suffix, ".", "CSV (*.csv" + suffix + ")");
+    if (file_name == "") {
+        return;
+    }
+    const ExportResult result = ExportQuery(header, query, file_name, compression);
+    if (!result.Ok()) {
+        ShowError(result.error);
     }
-    return '\"' + unexc.replace(QLatin1Char('\"'), QStringLiteral("\"\"")) + '\"';
 }
 
-void outfit::utils::csv::SaveQuery(const QString& header, QSqlQuery& query) {
+void outfit::utils::csv::SaveQueryPartitioned(
+    const QString& header, const QSqlDatabase& database, const PartitionedQuery& partition,
+    int chunks) {
     const QString file_name =
         QFileDialog::getSaveFileName(nullptr, "export.csv", ".", "CSV (*.csv)");
     if (file_name == "") {
         return;
     }
-    QFile csv_file(file_name);
-    if (!csv_file.open(QFile::WriteOnly | QFile::Text)) {
-        QMessageBox msg;
-        msg.setText("failed to open file");
-        msg.exec();
-        return;
+    const ExportResult result = ExportPartitioned(database, partition, header, file_name, chunks);
+    if (!result.Ok()) {
+        ShowError(result.error);
     }
-    if (!query.exec()) {
-        QMessageBox msg;
-        msg.setText("failed to run query");
-        msg.exec();
+}
+
+void outfit::utils::csv::SaveQueryResumable(
+    const QString& header, const QSqlDatabase& database, const PartitionedQuery& query,
+    const ResumableOptions& options) {
+    // The file of an interrupted export is chosen again on purpose, it is not overwritten.
+    const QString file_name = QFileDialog::getSaveFileName(
+        nullptr, "export.csv", ".", "CSV (*.csv)", nullptr, QFileDialog::DontConfirmOverwrite);
+    if (file_name == "") {
         return;
     }
-    QTextStream out_stream(&csv_file);
-    out_stream << header << "\n";
-    out_stream.setEncoding(QStringConverter::Utf8);
-    while (query.next()) {
-        const QSqlRecord record = query.record();
-        for (int i = 0, rec_count = record.count(); i < rec_count; ++i) {
-            if (i > 0) {
-                out_stream << ',';
-            }
-            out_stream << utils::csv::EscapeCSV(record.value(i).toString());
-        }
-        out_stream << '\n';
+    const ExportResult result = ExportResumable(database, query, header, file_name, options);
+    if (!result.Ok()) {
+        ShowError(result.error);
     }
 }
\ No newline at end of file
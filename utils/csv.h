@@ -5,13 +5,35 @@
 #ifndef CREATIVE_CSV_H
 #define CREATIVE_CSV_H
 
+#include "compressing_device.h"
+#include "csv_escape.h"
+#include "csv_export.h"
+#include "csv_partitioned.h"
+#include "csv_resumable.h"
+
+#include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QString>
+#include <QThread>
 
+// Interactive wrappers around the headless export functions. Batch tools should depend on
+// //utils:csv_core instead, which does not link QtWidgets.
 namespace outfit::utils::csv {
-QString EscapeCSV(QString unexc);
+// Asks for a file name and exports the prepared `query`, stream-compressed with `compression`.
+void SaveQuery(
+    const QString& header, QSqlQuery& query, const CompressionOptions& compression = {});
+
+// Asks for a file name and exports `partition` split into `chunks` key ranges that are queried
+// concurrently, see ExportPartitioned().
+void SaveQueryPartitioned(
+    const QString& header, const QSqlDatabase& database, const PartitionedQuery& partition,
+    int chunks = QThread::idealThreadCount());
 
-void SaveQuery(const QString& header, QSqlQuery& query);
+// Asks for a file name and exports `query` with checkpoints, see ExportResumable(). Choosing the
+// file of an interrupted export continues it.
+void SaveQueryResumable(
+    const QString& header, const QSqlDatabase& database, const PartitionedQuery& query,
+    const ResumableOptions& options = {});
 }  // namespace outfit::utils::csv
 
 #endif  // CREATIVE_CSV_H
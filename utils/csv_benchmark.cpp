@@ -0,0 +1,469 @@
+#include "bulk_inserter.h"
+#include "columnar_writer.h"
+#include "compressing_device.h"
+#include "csv_escape.h"
+#include "csv_export.h"
+#include "csv_sink.h"
+#include "tools/util/util.h"
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QFile>
+#include <QIODevice>
+#include <QLatin1Char>
+#include <QList>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+#include <QStringLiteral>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QVariant>
+#include <benchmark/benchmark.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr int64_t kCells = 10'000'000;
+constexpr int kCellPool = 4096;
+constexpr int kCellWidth = 16;
+constexpr int kColumns = 8;
+constexpr int kWideRows = 100'000;
+constexpr int kWideColumns = 64;
+constexpr auto kBenchmarkConnection = "csv_benchmark";
+constexpr auto kShapeConnection = "csv_benchmark_shape";
+
+// Discards everything written to it, so only the formatting and encoding cost is measured.
+class NullDevice : public QIODevice {
+   public:
+    NullDevice() {
+        open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+    }
+
+    [[nodiscard]] bool isSequential() const override {
+        return true;
+    }
+
+    [[nodiscard]] qint64 Written() const {
+        return written_;
+    }
+
+   protected:
+    qint64 readData(char* /*data*/, qint64 /*maxlen*/) override {
+        return -1;
+    }
+
+    qint64 writeData(const char* /*data*/, qint64 len) override {
+        written_ += len;
+        return len;
+    }
+
+   private:
+    qint64 written_ = 0;
+};
+
+// The escaping routine SaveQuery used before AppendEscapedCSV, kept as the baseline.
+QString LegacyEscapeCSV(QString unexc) {
+    if (!unexc.contains(QLatin1Char(','))) {
+        return unexc;
+    }
+    return '\"' + unexc.replace(QLatin1Char('\"'), QStringLiteral("\"\"")) + '\"';
+}
+
+// `width` characters per cell, `quoted_percent` of the cells contain a comma and a quote.
+QStringList MakeCells(int width = kCellWidth, int quoted_percent = 10) {
+    RandomGenerator gen;
+    QStringList cells;
+    cells.reserve(kCellPool);
+    for (int i = 0; i < kCellPool; ++i) {
+        std::string cell = gen.GenString(width);
+        if (width > 0 && gen.GenInt(0, 99) < quoted_percent) {
+            cell[width / 2] = ',';
+            cell[width / 4] = '"';
+        }
+        cells.append(QString::fromStdString(cell));
+    }
+    return cells;
+}
+
+// A wide table where every third cell is Cyrillic text, so UTF-8 encoding is not a plain copy.
+QList<QStringList> MakeWideRows() {
+    const QStringList cells = MakeCells();
+    const QString cyrillic = QStringLiteral("Привет, мир");
+    QList<QStringList> rows(kWideRows);
+    for (int r = 0; r < kWideRows; ++r) {
+        rows[r].reserve(kWideColumns);
+        for (int c = 0; c < kWideColumns; ++c) {
+            rows[r].append(c % 3 == 0 ? cyrillic : cells[((r * kWideColumns) + c) % kCellPool]);
+        }
+    }
+    return rows;
+}
+
+void BM_LegacyEscapeCSV(benchmark::State& state) {
+    const QStringList cells = MakeCells();
+    for (auto _ : state) {
+        QString row;
+        for (int64_t i = 0; i < kCells; ++i) {
+            if (i % kColumns == 0) {
+                row = QString();
+            }
+            row += LegacyEscapeCSV(cells[i % kCellPool]);
+            row += ',';
+        }
+        benchmark::DoNotOptimize(row);
+    }
+    state.SetItemsProcessed(state.iterations() * kCells);
+}
+
+void BM_EscapeCSV(benchmark::State& state) {
+    const QStringList cells = MakeCells();
+    for (auto _ : state) {
+        QString row;
+        for (int64_t i = 0; i < kCells; ++i) {
+            if (i % kColumns == 0) {
+                row = QString();
+            }
+            row += outfit::utils::csv::EscapeCSV(cells[i % kCellPool]);
+            row += ',';
+        }
+        benchmark::DoNotOptimize(row);
+    }
+    state.SetItemsProcessed(state.iterations() * kCells);
+}
+
+void BM_AppendEscapedCSV(benchmark::State& state) {
+    const QStringList cells = MakeCells();
+    for (auto _ : state) {
+        QString row;
+        for (int64_t i = 0; i < kCells; ++i) {
+            if (i % kColumns == 0) {
+                row.truncate(0);
+            }
+            outfit::utils::csv::AppendEscapedCSV(cells[i % kCellPool], row);
+            row.append(QLatin1Char(','));
+        }
+        benchmark::DoNotOptimize(row);
+    }
+    state.SetItemsProcessed(state.iterations() * kCells);
+}
+
+void BM_TextStreamWriter(benchmark::State& state) {
+    const QList<QStringList> rows = MakeWideRows();
+    int64_t bytes = 0;
+    for (auto _ : state) {
+        NullDevice device;
+        QTextStream out_stream(&device);
+        out_stream.setEncoding(QStringConverter::Utf8);
+        for (const QStringList& row : rows) {
+            for (int i = 0; i < row.size(); ++i) {
+                if (i > 0) {
+                    out_stream << ',';
+                }
+                out_stream << LegacyEscapeCSV(row[i]);
+            }
+            out_stream << '\n';
+        }
+        out_stream.flush();
+        bytes += out_stream.pos();
+    }
+    state.SetBytesProcessed(bytes);
+    state.SetItemsProcessed(state.iterations() * kWideRows);
+}
+
+void BM_CsvSink(benchmark::State& state) {
+    const QList<QStringList> rows = MakeWideRows();
+    QString line;
+    int64_t bytes = 0;
+    for (auto _ : state) {
+        NullDevice device;
+        outfit::utils::csv::CsvSink sink(&device);
+        for (const QStringList& row : rows) {
+            line.truncate(0);
+            for (int i = 0; i < row.size(); ++i) {
+                if (i > 0) {
+                    line.append(QLatin1Char(','));
+                }
+                outfit::utils::csv::AppendEscapedCSV(row[i], line);
+            }
+            line.append(QLatin1Char('\n'));
+            sink.WriteRow(line);
+        }
+        sink.Flush();
+        bytes += sink.BytesWritten();
+    }
+    state.SetBytesProcessed(bytes);
+    state.SetItemsProcessed(state.iterations() * kWideRows);
+}
+
+// Stops `state` with `error` and returns false, so setup code can `return Skip(...)`.
+bool Skip(benchmark::State& state, const QString& error) {
+    state.SkipWithError(error.toStdString());
+    return false;
+}
+
+// Fills an on-disk SQLite table `t(id, amount, name)` so the database itself does not live in
+// process memory and only the export path shows up in the peak RSS.
+bool MakeDatabase(
+    benchmark::State& state, const QString& path, int64_t rows, QSqlDatabase& database) {
+    database = QSqlDatabase::addDatabase("QSQLITE", kBenchmarkConnection);
+    database.setDatabaseName(path);
+    if (!database.open()) {
+        return Skip(state, database.lastError().text());
+    }
+    QSqlQuery query(database);
+    if (!query.exec("CREATE TABLE t (id INTEGER PRIMARY KEY, amount REAL, name TEXT)")) {
+        return Skip(state, query.lastError().text());
+    }
+    if (!database.transaction()) {
+        return Skip(state, database.lastError().text());
+    }
+    if (!query.prepare("INSERT INTO t (id, amount, name) VALUES (?, ?, ?)")) {
+        return Skip(state, query.lastError().text());
+    }
+    RandomGenerator gen;
+    for (int64_t i = 0; i < rows; ++i) {
+        query.addBindValue(QVariant::fromValue(i));
+        query.addBindValue(static_cast<double>(i) / 7.0);
+        query.addBindValue(QString::fromStdString(gen.GenString(kCellWidth)));
+        if (!query.exec()) {
+            return Skip(state, query.lastError().text());
+        }
+    }
+    if (!database.commit()) {
+        return Skip(state, database.lastError().text());
+    }
+    return true;
+}
+
+#ifdef __linux__
+// Resident set size of the process right now, unlike GetMemoryUsage(), which is the peak of the
+// whole process and so includes every benchmark that ran before.
+int64_t CurrentRssKb() {
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QFile::ReadOnly)) {
+        return 0;
+    }
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    return fields.size() > 1 ? fields[1].toLongLong() * sysconf(_SC_PAGESIZE) / 1024 : 0;
+}
+#endif
+
+// The export loop over `database`; the memory it adds must not grow with the row count.
+void ExportRowLoop(benchmark::State& state, const QSqlDatabase& database) {
+#ifdef __linux__
+    const int64_t rss_before_kb = CurrentRssKb();
+#endif
+    for (auto _ : state) {
+        QSqlQuery query(database);
+        query.prepare("SELECT id, amount, name FROM t ORDER BY id");
+        NullDevice device;
+        const outfit::utils::csv::ExportResult result =
+            outfit::utils::csv::ExportQuery("id,amount,name", query, &device);
+        if (!result.Ok()) {
+            state.SkipWithError(result.error.toStdString());
+            break;
+        }
+    }
+#ifdef __linux__
+    // Measured while the database is still open, so only the loop's own memory counts.
+    state.counters["rss_delta_kb"] = static_cast<double>(CurrentRssKb() - rss_before_kb);
+#endif
+}
+
+void BM_ExportRowLoop(benchmark::State& state) {
+    const int64_t rows = state.range(0);
+    const QTemporaryDir dir;
+    {
+        QSqlDatabase database;
+        if (MakeDatabase(state, dir.filePath("bench.sqlite"), rows, database)) {
+            ExportRowLoop(state, database);
+        }
+    }
+    QSqlDatabase::removeDatabase(kBenchmarkConnection);
+    state.SetItemsProcessed(state.iterations() * rows);
+}
+
+// Shape of the generated table, taken from the benchmark arguments.
+struct TableShape {
+    int64_t rows;
+    int columns;
+    int width;
+    int quoted_percent;
+
+    explicit TableShape(const benchmark::State& state)
+        : rows(state.range(0))
+        , columns(static_cast<int>(state.range(1)))
+        , width(static_cast<int>(state.range(2)))
+        , quoted_percent(static_cast<int>(state.range(3))) {
+    }
+};
+
+// An in-memory SQLite table `s(id, c0, ..., cN)` of `shape`, filled through BulkInserter.
+bool MakeShapedDatabase(benchmark::State& state, const TableShape& shape, QSqlDatabase& database) {
+    database = QSqlDatabase::addDatabase("QSQLITE", kShapeConnection);
+    database.setDatabaseName(":memory:");
+    if (!database.open()) {
+        return Skip(state, database.lastError().text());
+    }
+    QStringList columns = {"id"};
+    for (int c = 0; c < shape.columns; ++c) {
+        columns.append(QStringLiteral("c%1").arg(c));
+    }
+    QSqlQuery query(database);
+    if (!query.exec(QStringLiteral("CREATE TABLE s (id INTEGER PRIMARY KEY, %1 TEXT)")
+                        .arg(columns.mid(1).join(" TEXT, ")))) {
+        return Skip(state, query.lastError().text());
+    }
+    const QStringList cells = MakeCells(shape.width, shape.quoted_percent);
+    outfit::utils::BulkInserter inserter(database, "s", columns);
+    for (int64_t r = 0; r < shape.rows; ++r) {
+        inserter.AddValue(QVariant::fromValue(r));
+        for (int c = 0; c < shape.columns; ++c) {
+            inserter.AddValue(cells[((r * shape.columns) + c) % kCellPool]);
+        }
+        if (!inserter.EndRow()) {
+            return Skip(state, inserter.ErrorString());
+        }
+    }
+    if (!inserter.Finish()) {
+        return Skip(state, inserter.ErrorString());
+    }
+    return true;
+}
+
+// Runs `body` with a prepared query over the shaped table and removes the connection afterwards.
+template <class Body>
+void WithShapedQuery(benchmark::State& state, Body body) {
+    const TableShape shape(state);
+    {
+        QSqlDatabase database;
+        if (MakeShapedDatabase(state, shape, database)) {
+            for (auto _ : state) {
+                QSqlQuery query(database);
+                query.prepare("SELECT * FROM s ORDER BY id");
+                if (!body(query)) {
+                    break;
+                }
+            }
+        }
+    }
+    QSqlDatabase::removeDatabase(kShapeConnection);
+    state.SetItemsProcessed(state.iterations() * shape.rows);
+}
+
+void BM_ShapedEscapeCSV(benchmark::State& state) {
+    const TableShape shape(state);
+    const QStringList cells = MakeCells(shape.width, shape.quoted_percent);
+    const int64_t count = shape.rows * shape.columns;
+    QString row;
+    for (auto _ : state) {
+        for (int64_t i = 0; i < count; ++i) {
+            if (i % shape.columns == 0) {
+                row.truncate(0);
+            }
+            row += outfit::utils::csv::EscapeCSV(cells[i % kCellPool]);
+            row += ',';
+        }
+        benchmark::DoNotOptimize(row);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetBytesProcessed(
+        state.iterations() * count * shape.width * static_cast<int64_t>(sizeof(QChar)));
+}
+
+// SaveQuery's row loop without the dialog: query, CellFormatter, CsvSink and optional compression.
+void BM_ShapedExportQuery(benchmark::State& state) {
+    outfit::utils::csv::CompressionOptions compression;
+    compression.codec = static_cast<outfit::utils::csv::Codec>(state.range(4));
+    int64_t bytes = 0;
+    WithShapedQuery(state, [&](QSqlQuery& query) {
+        NullDevice device;
+        const outfit::utils::csv::ExportResult result =
+            outfit::utils::csv::ExportQuery({}, query, &device, compression);
+        if (!result.Ok()) {
+            state.SkipWithError(result.error.toStdString());
+            return false;
+        }
+        bytes += result.bytes;
+        state.counters["output_bytes"] = static_cast<double>(device.Written());
+        return true;
+    });
+    state.SetBytesProcessed(bytes);
+}
+
+void BM_ShapedColumnar(benchmark::State& state) {
+    int64_t bytes = 0;
+    WithShapedQuery(state, [&](QSqlQuery& query) {
+        query.setForwardOnly(true);
+        if (!query.exec()) {
+            return Skip(state, query.lastError().text());
+        }
+        NullDevice device;
+        outfit::utils::columnar::ColumnarWriter writer(&device, query.record());
+        while (query.next()) {
+            if (!writer.AppendRow(query)) {
+                return Skip(state, writer.ErrorString());
+            }
+        }
+        if (!writer.Finish()) {
+            state.SkipWithError(writer.ErrorString().toStdString());
+            return false;
+        }
+        bytes += device.Written();
+        return true;
+    });
+    state.SetBytesProcessed(bytes);
+}
+
+// rows x columns x string width x percentage of cells that need quoting.
+void ShapeArgs(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"rows", "columns", "width", "quoted%"});
+    benchmark->Args({100'000, 8, 16, 0});
+    benchmark->Args({100'000, 8, 16, 10});
+    benchmark->Args({100'000, 8, 16, 50});
+    benchmark->Args({100'000, 32, 64, 10});
+    benchmark->Args({1'000'000, 4, 8, 10});
+}
+
+// ShapeArgs() for every codec as the fifth argument.
+void ShapeCodecArgs(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"rows", "columns", "width", "quoted%", "codec"});
+    for (const auto codec : {outfit::utils::csv::Codec::None, outfit::utils::csv::Codec::Gzip,
+                             outfit::utils::csv::Codec::Zstd}) {
+        benchmark->Args({100'000, 8, 16, 10, static_cast<int64_t>(codec)});
+    }
+    benchmark->Args({100'000, 8, 16, 50, 0});
+    benchmark->Args({100'000, 32, 64, 10, 0});
+    benchmark->Args({1'000'000, 4, 8, 10, 0});
+}
+}  // namespace
+
+BENCHMARK(BM_LegacyEscapeCSV)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EscapeCSV)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_AppendEscapedCSV)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TextStreamWriter)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CsvSink)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ExportRowLoop)
+    ->RangeMultiplier(10)
+    ->Range(10'000, 1'000'000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ShapedEscapeCSV)->Apply(ShapeArgs)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ShapedExportQuery)->Apply(ShapeCodecArgs)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ShapedColumnar)->Apply(ShapeArgs)->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv) {
+    // The QSQLITE driver is a plugin, found only once an application object exists.
+    const QCoreApplication app(argc, argv);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
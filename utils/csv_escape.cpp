@@ -0,0 +1,45 @@
+#include "csv_escape.h"
+
+#include <QLatin1Char>
+#include <algorithm>
+
+namespace {
+bool NeedsQuoting(char16_t c) {
+    return c == u',' || c == u'"' || c == u'\n' || c == u'\r';
+}
+}  // namespace
+
+void outfit::utils::csv::AppendEscapedCSV(QStringView field, QString& out) {
+    const char16_t* const begin = field.utf16();
+    const char16_t* const end = begin + field.size();
+    const char16_t* it = begin;
+    while (it != end && !NeedsQuoting(*it)) {
+        ++it;
+    }
+    if (it == end) {
+        out.append(field);
+        return;
+    }
+    out.append(QLatin1Char('"'));
+    const char16_t* run = begin;
+    for (; it != end; ++it) {
+        if (*it == u'"') {
+            // Emit the run including this quote, then start the next run at it to double it.
+            out.append(QStringView(run, it + 1));
+            run = it;
+        }
+    }
+    out.append(QStringView(run, end));
+    out.append(QLatin1Char('"'));
+}
+
+QString outfit::utils::csv::EscapeCSV(const QString& unexc) {
+    const auto needs_quoting = [](QChar c) { return NeedsQuoting(c.unicode()); };
+    if (std::none_of(unexc.cbegin(), unexc.cend(), needs_quoting)) {
+        return unexc;
+    }
+    QString escaped;
+    escaped.reserve(unexc.size() + 2);
+    AppendEscapedCSV(unexc, escaped);
+    return escaped;
+}
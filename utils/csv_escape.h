@@ -0,0 +1,15 @@
+#ifndef CREATIVE_CSV_ESCAPE_H
+#define CREATIVE_CSV_ESCAPE_H
+
+#include <QString>
+#include <QStringView>
+
+namespace outfit::utils::csv {
+// Appends `field` to `out`, quoting it when it contains a comma, a quote, CR or LF and doubling
+// embedded quotes. Scans the field once and never allocates when `out` has enough capacity.
+void AppendEscapedCSV(QStringView field, QString& out);
+
+QString EscapeCSV(const QString& unexc);
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_CSV_ESCAPE_H
@@ -0,0 +1,23 @@
+#include "csv_export.h"
+
+#include "csv_export_job.h"
+
+namespace outfit::utils::csv {
+ExportResult ExportQuery(
+    const QString& header, QSqlQuery& query, const QString& file_name,
+    const CompressionOptions& compression) {
+    CsvExportJob job(header, file_name);
+    job.SetCompression(compression);
+    job.Run(query);
+    return job.Result();
+}
+
+ExportResult ExportQuery(
+    const QString& header, QSqlQuery& query, QIODevice* device,
+    const CompressionOptions& compression) {
+    CsvExportJob job(header, QString());
+    job.SetCompression(compression);
+    job.Run(query, device);
+    return job.Result();
+}
+}  // namespace outfit::utils::csv
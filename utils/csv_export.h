@@ -0,0 +1,39 @@
+#ifndef CREATIVE_CSV_EXPORT_H
+#define CREATIVE_CSV_EXPORT_H
+
+#include "compressing_device.h"
+
+#include <QIODevice>
+#include <QSqlQuery>
+#include <QString>
+
+namespace outfit::utils::csv {
+// Outcome of an export.
+struct ExportResult {
+    // Empty on success.
+    QString error;
+    qint64 rows = 0;
+    // Bytes of CSV produced, including the header and before compression.
+    qint64 bytes = 0;
+
+    [[nodiscard]] bool Ok() const {
+        return error.isEmpty();
+    }
+};
+
+// Executes the prepared `query` and writes `header` and its rows to `file_name`. The file is
+// removed if the export fails. Needs neither QtWidgets nor a display.
+//
+// `query` is switched to forward-only before it is executed so that drivers can stream the rows;
+// the caller's query stays forward-only afterwards.
+ExportResult ExportQuery(
+    const QString& header, QSqlQuery& query, const QString& file_name,
+    const CompressionOptions& compression = {});
+
+// Same as above, but writes to the open `device`, which is left open and is not removed.
+ExportResult ExportQuery(
+    const QString& header, QSqlQuery& query, QIODevice* device,
+    const CompressionOptions& compression = {});
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_CSV_EXPORT_H
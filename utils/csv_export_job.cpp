@@ -0,0 +1,230 @@
+#include "csv_export_job.h"
+
+#include "csv_escape.h"
+#include "csv_format.h"
+#include "csv_sink.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QLatin1Char>
+#include <QSqlError>
+#include <QSqlRecord>
+#include <QStringLiteral>
+#include <utility>
+
+namespace outfit::utils::csv {
+namespace {
+// Progress is reported at most this often; the clock is sampled every kProgressCheckRows rows.
+constexpr qint64 kProgressIntervalMs = 200;
+constexpr qint64 kProgressCheckRows = 1024;
+
+QString NextConnectionName() {
+    static std::atomic<quint64> counter = 0;
+    return QStringLiteral("outfit_csv_export_%1").arg(counter.fetch_add(1));
+}
+
+double RowsPerSecond(qint64 rows, qint64 elapsed_ms) {
+    return elapsed_ms > 0 ? static_cast<double>(rows) * 1000.0 / static_cast<double>(elapsed_ms)
+                          : 0.0;
+}
+}  // namespace
+
+CsvExportJob::CsvExportJob(QString header, QString file_name, QObject* parent)
+    : QObject(parent), header_(std::move(header)), file_name_(std::move(file_name)) {
+}
+
+CsvExportJob::~CsvExportJob() {
+    Cancel();
+    Wait();
+}
+
+void CsvExportJob::SetCompression(const CompressionOptions& compression) {
+    compression_ = compression;
+}
+
+void CsvExportJob::SetHeaderFromColumns(bool enabled) {
+    header_from_columns_ = enabled;
+}
+
+void CsvExportJob::Start(
+    const QSqlDatabase& database, const QString& sql, const QVariantList& bound_values) {
+    if (IsRunning()) {
+        return;
+    }
+    Wait();
+    Reset();
+
+    const QString source_connection = database.connectionName();
+    thread_.reset(QThread::create([this, source_connection, sql, bound_values] {
+        const QString connection_name = NextConnectionName();
+        bool ok = false;
+        {
+            // QSqlDatabase connections may only be used by the thread that created them.
+            QSqlDatabase worker_database =
+                QSqlDatabase::cloneDatabase(source_connection, connection_name);
+            if (!worker_database.open()) {
+                error_ = "failed to open database: " + worker_database.lastError().text();
+            } else {
+                QSqlQuery query(worker_database);
+                if (!query.prepare(sql)) {
+                    error_ = "failed to prepare query: " + query.lastError().text();
+                } else {
+                    for (const QVariant& value : bound_values) {
+                        query.addBindValue(value);
+                    }
+                    ok = Export(query);
+                }
+            }
+        }
+        QSqlDatabase::removeDatabase(connection_name);
+        emit Finished(ok);
+    }));
+    thread_->start();
+}
+
+bool CsvExportJob::Run(QSqlQuery& query) {
+    Reset();
+    return Export(query);
+}
+
+bool CsvExportJob::Run(QSqlQuery& query, QIODevice* device) {
+    Reset();
+    return Export(query, device);
+}
+
+void CsvExportJob::Cancel() {
+    cancel_requested_ = true;
+}
+
+bool CsvExportJob::Wait(QDeadlineTimer deadline) {
+    return !thread_ || thread_->wait(deadline);
+}
+
+bool CsvExportJob::IsRunning() const {
+    return thread_ && thread_->isRunning();
+}
+
+bool CsvExportJob::IsCancelled() const {
+    return cancel_requested_;
+}
+
+qint64 CsvExportJob::RowsWritten() const {
+    return rows_written_;
+}
+
+qint64 CsvExportJob::BytesWritten() const {
+    return bytes_written_;
+}
+
+QString CsvExportJob::ErrorString() const {
+    return error_;
+}
+
+ExportResult CsvExportJob::Result() const {
+    return {error_, rows_written_, bytes_written_};
+}
+
+void CsvExportJob::Reset() {
+    cancel_requested_ = false;
+    rows_written_ = 0;
+    bytes_written_ = 0;
+    error_.clear();
+}
+
+bool CsvExportJob::Export(QSqlQuery& query) {
+    QFile csv_file(file_name_);
+    if (!csv_file.open(QFile::WriteOnly | QFile::Unbuffered)) {
+        error_ = "failed to open file: " + csv_file.errorString();
+        return false;
+    }
+    if (!Export(query, &csv_file)) {
+        // Never leave a truncated file behind that looks like a complete export.
+        csv_file.remove();
+        return false;
+    }
+    return true;
+}
+
+bool CsvExportJob::Export(QSqlQuery& query, QIODevice* device) {
+    // Forward-only results let drivers stream rows instead of caching the whole result set.
+    query.setForwardOnly(true);
+    if (!query.exec()) {
+        error_ = "failed to run query";
+        return false;
+    }
+    QIODevice* output = device;
+    std::unique_ptr<CompressingDevice> compressed;
+    if (compression_.codec != Codec::None) {
+        compressed = std::make_unique<CompressingDevice>(device, compression_);
+        if (!compressed->open(QIODevice::WriteOnly)) {
+            error_ = "failed to start compression: " + compressed->errorString();
+            return false;
+        }
+        output = compressed.get();
+    }
+    CsvSink sink(output);
+    const QSqlRecord record = query.record();
+    QString row;
+    if (!header_from_columns_) {
+        row = header_;
+    } else {
+        for (int i = 0; i < record.count(); ++i) {
+            if (i > 0) {
+                row.append(QLatin1Char(','));
+            }
+            AppendEscapedCSV(record.fieldName(i), row);
+        }
+    }
+    row.append(QLatin1Char('\n'));
+    sink.WriteRow(row);
+
+    const CellFormatter formatter(record);
+    QElapsedTimer timer;
+    timer.start();
+    qint64 last_report_ms = 0;
+    qint64 rows = 0;
+    while (query.next()) {
+        if (cancel_requested_.load(std::memory_order_relaxed)) {
+            sink.Flush();
+            if (compressed) {
+                compressed->Finish();
+            }
+            error_ = "export cancelled";
+            return false;
+        }
+        row.truncate(0);
+        formatter.AppendRow(query, row);
+        if (!sink.WriteRow(row)) {
+            break;
+        }
+
+        ++rows;
+        if (rows % kProgressCheckRows == 0) {
+            rows_written_.store(rows, std::memory_order_relaxed);
+            bytes_written_.store(sink.BytesWritten(), std::memory_order_relaxed);
+            if (const qint64 elapsed_ms = timer.elapsed();
+                elapsed_ms - last_report_ms >= kProgressIntervalMs) {
+                last_report_ms = elapsed_ms;
+                ReportProgress(rows, elapsed_ms);
+            }
+        }
+    }
+    const bool flushed = sink.Flush();
+    rows_written_ = rows;
+    bytes_written_ = sink.BytesWritten();
+    ReportProgress(rows, timer.elapsed());
+    if (!flushed) {
+        error_ = "failed to write file: " + sink.ErrorString();
+        return false;
+    }
+    if (compressed && !compressed->Finish()) {
+        error_ = "failed to write file: " + compressed->errorString();
+        return false;
+    }
+    return true;
+}
+
+void CsvExportJob::ReportProgress(qint64 rows, qint64 elapsed_ms) {
+    emit Progress(rows, RowsPerSecond(rows, elapsed_ms));
+}
+}  // namespace outfit::utils::csv
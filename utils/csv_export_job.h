@@ -0,0 +1,90 @@
+#ifndef CREATIVE_CSV_EXPORT_JOB_H
+#define CREATIVE_CSV_EXPORT_JOB_H
+
+#include "compressing_device.h"
+#include "csv_export.h"
+
+#include <QDeadlineTimer>
+#include <QIODevice>
+#include <QObject>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QThread>
+#include <QVariantList>
+#include <atomic>
+#include <memory>
+
+namespace outfit::utils::csv {
+// Executes a query and streams its rows into a CSV file.
+//
+// Start() runs the export on a worker thread over its own clone of the database connection, so
+// the caller's thread only receives queued Progress() and Finished() signals. Run() performs the
+// same export synchronously on an already prepared query.
+class CsvExportJob : public QObject {
+    Q_OBJECT
+
+   public:
+    CsvExportJob(QString header, QString file_name, QObject* parent = nullptr);
+    ~CsvExportJob() override;
+
+    CsvExportJob(const CsvExportJob&) = delete;
+    CsvExportJob& operator=(const CsvExportJob&) = delete;
+    CsvExportJob(CsvExportJob&&) = delete;
+    CsvExportJob& operator=(CsvExportJob&&) = delete;
+
+    // Stream-compresses the file while rows are written. Takes effect on the next export.
+    void SetCompression(const CompressionOptions& compression);
+    // Writes the column names of the result as the header instead of the constructor's header,
+    // for queries whose columns are not known up front. Takes effect on the next export.
+    void SetHeaderFromColumns(bool enabled);
+
+    // Prepares `sql` on a clone of `database` in a worker thread, binds `bound_values`
+    // positionally and exports the result. Does nothing if the job is already running.
+    void Start(
+        const QSqlDatabase& database, const QString& sql, const QVariantList& bound_values = {});
+
+    // Executes the prepared `query` on the calling thread and exports the result. `query` is
+    // switched to forward-only first, so afterwards it can only be read once, front to back.
+    bool Run(QSqlQuery& query);
+    // Same as Run(), but writes to the open `device` instead of the job's file.
+    bool Run(QSqlQuery& query, QIODevice* device);
+
+    // Requests cancellation; the worker stops before the next row and removes the partial file.
+    void Cancel();
+    // Blocks until the worker thread finishes. Returns false on timeout.
+    bool Wait(QDeadlineTimer deadline = QDeadlineTimer(QDeadlineTimer::Forever));
+
+    [[nodiscard]] bool IsRunning() const;
+    [[nodiscard]] bool IsCancelled() const;
+    [[nodiscard]] qint64 RowsWritten() const;
+    // UTF-8 bytes written to the file, including the header.
+    [[nodiscard]] qint64 BytesWritten() const;
+    // Valid after Finished() was emitted or Run() returned.
+    [[nodiscard]] QString ErrorString() const;
+    // Error, rows and bytes of the last export, valid like ErrorString().
+    [[nodiscard]] ExportResult Result() const;
+
+   signals:
+    void Progress(qint64 rows, double rows_per_second);
+    void Finished(bool ok);
+
+   private:
+    void Reset();
+    bool Export(QSqlQuery& query);
+    bool Export(QSqlQuery& query, QIODevice* device);
+    void ReportProgress(qint64 rows, qint64 elapsed_ms);
+
+    QString header_;
+    QString file_name_;
+    CompressionOptions compression_;
+    bool header_from_columns_ = false;
+    QString error_;
+    std::unique_ptr<QThread> thread_;
+    std::atomic<bool> cancel_requested_ = false;
+    std::atomic<qint64> rows_written_ = 0;
+    std::atomic<qint64> bytes_written_ = 0;
+};
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_CSV_EXPORT_JOB_H
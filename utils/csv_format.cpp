@@ -0,0 +1,270 @@
+#include "csv_format.h"
+
+#include "csv_escape.h"
+
+#include <QDate>
+#include <QDateTime>
+#include <QLatin1Char>
+#include <QLatin1String>
+#include <QTime>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+
+namespace outfit::utils::csv {
+namespace {
+using Buffer = std::array<char, 64>;
+
+void AppendAscii(const char* begin, const char* end, QString& out) {
+    out.append(QLatin1String(begin, end));
+}
+
+template <class T>
+void AppendNumber(T value, QString& out) {
+    Buffer buffer;
+    const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+    AppendAscii(buffer.data(), result.ptr, out);
+}
+
+// For double, the same output as QString::number(value, 'g', QLocale::FloatingPointShortest):
+// the shortest digits that round-trip, in the shorter of the fixed and the exponent form, fixed on
+// a tie, with at least two exponent digits. std::to_chars' general format breaks ties and picks
+// the form differently (it prints 1e5 as "100000", Qt as "1e+05"), so only its digits are used. A
+// float gets the shortest digits of the float, so 0.1f is "0.1" like the double 0.1.
+template <class T>
+void AppendFloating(T value, QString& out) {
+    if (std::isnan(value)) {
+        out.append(QLatin1String("nan"));
+        return;
+    }
+    if (std::isinf(value)) {
+        out.append(value < 0 ? QLatin1String("-inf") : QLatin1String("inf"));
+        return;
+    }
+    // d[.ddd]e(+|-)xx[x]
+    Buffer scientific;
+    const auto result = std::to_chars(
+        scientific.data(), scientific.data() + scientific.size(), value,
+        std::chars_format::scientific);
+    const char* const end = result.ptr;
+    const char* it = scientific.data();
+    const bool negative = *it == '-';
+    it += negative ? 1 : 0;
+    const char* const exponent_mark = std::find(it, end, 'e');
+    std::array<char, 32> digits{};
+    int digit_count = 0;
+    for (const char* digit = it; digit != exponent_mark; ++digit) {
+        if (*digit != '.') {
+            digits[digit_count++] = *digit;
+        }
+    }
+    int exponent = 0;
+    std::from_chars(exponent_mark + (exponent_mark[1] == '+' ? 2 : 1), end, exponent);
+    // Digits before the decimal point in the fixed form; zero or less for 0.0x.
+    const int point = exponent + 1;
+    const int fixed_size = point <= 0              ? 2 - point + digit_count
+                           : point >= digit_count ? point
+                                                   : digit_count + 1;
+    const int exponent_size = static_cast<int>(end - exponent_mark) +
+                              static_cast<int>(exponent_mark - it);
+    if (fixed_size > exponent_size) {
+        AppendAscii(scientific.data(), end, out);
+        return;
+    }
+
+    Buffer fixed;
+    char* put = fixed.data();
+    if (negative) {
+        *put++ = '-';
+    }
+    if (point <= 0) {
+        *put++ = '0';
+        *put++ = '.';
+        put = std::fill_n(put, -point, '0');
+        put = std::copy_n(digits.data(), digit_count, put);
+    } else if (point >= digit_count) {
+        put = std::copy_n(digits.data(), digit_count, put);
+        put = std::fill_n(put, point - digit_count, '0');
+    } else {
+        put = std::copy_n(digits.data(), point, put);
+        *put++ = '.';
+        put = std::copy_n(digits.data() + point, digit_count - point, put);
+    }
+    AppendAscii(fixed.data(), put, out);
+}
+
+char* PutDigits(char* out, int value, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + (value % 10));
+        value /= 10;
+    }
+    return out + width;
+}
+
+// yyyy-MM-dd, or nullptr for years Qt::ISODate would not print with four digits.
+char* PutDate(char* out, QDate date) {
+    int year = 0;
+    int month = 0;
+    int day = 0;
+    date.getDate(&year, &month, &day);
+    if (year < 0 || year > 9999) {
+        return nullptr;
+    }
+    out = PutDigits(out, year, 4);
+    *out++ = '-';
+    out = PutDigits(out, month, 2);
+    *out++ = '-';
+    return PutDigits(out, day, 2);
+}
+
+// HH:mm:ss.zzz, as Qt::ISODateWithMs.
+char* PutTime(char* out, QTime time) {
+    out = PutDigits(out, time.hour(), 2);
+    *out++ = ':';
+    out = PutDigits(out, time.minute(), 2);
+    *out++ = ':';
+    out = PutDigits(out, time.second(), 2);
+    *out++ = '.';
+    return PutDigits(out, time.msec(), 3);
+}
+
+bool AppendDate(const QDate& date, QString& out) {
+    Buffer buffer;
+    char* const end = date.isValid() ? PutDate(buffer.data(), date) : nullptr;
+    if (end == nullptr) {
+        return false;
+    }
+    AppendAscii(buffer.data(), end, out);
+    return true;
+}
+
+bool AppendTime(const QTime& time, QString& out) {
+    if (!time.isValid()) {
+        return false;
+    }
+    Buffer buffer;
+    AppendAscii(buffer.data(), PutTime(buffer.data(), time), out);
+    return true;
+}
+
+bool AppendDateTime(const QDateTime& date_time, QString& out) {
+    const Qt::TimeSpec spec = date_time.timeSpec();
+    if (!date_time.isValid() || (spec != Qt::LocalTime && spec != Qt::UTC)) {
+        return false;
+    }
+    Buffer buffer;
+    char* end = PutDate(buffer.data(), date_time.date());
+    if (end == nullptr) {
+        return false;
+    }
+    *end++ = 'T';
+    end = PutTime(end, date_time.time());
+    if (spec == Qt::UTC) {
+        *end++ = 'Z';
+    }
+    AppendAscii(buffer.data(), end, out);
+    return true;
+}
+
+// Returns false when `value` has to go through the generic toString() path.
+bool AppendTyped(CellFormatter::Kind kind, const QVariant& value, QString& out) {
+    using Kind = CellFormatter::Kind;
+    const void* const data = value.constData();
+    switch (kind) {
+        case Kind::String:
+            AppendEscapedCSV(*static_cast<const QString*>(data), out);
+            return true;
+        case Kind::Bool:
+            out.append(
+                *static_cast<const bool*>(data) ? QLatin1String("true") : QLatin1String("false"));
+            return true;
+        case Kind::Int:
+            AppendNumber(value.toLongLong(), out);
+            return true;
+        case Kind::UInt:
+            AppendNumber(value.toULongLong(), out);
+            return true;
+        case Kind::Float:
+            AppendFloating(*static_cast<const float*>(data), out);
+            return true;
+        case Kind::Double:
+            AppendFloating(*static_cast<const double*>(data), out);
+            return true;
+        case Kind::Date:
+            return AppendDate(*static_cast<const QDate*>(data), out);
+        case Kind::Time:
+            return AppendTime(*static_cast<const QTime*>(data), out);
+        case Kind::DateTime:
+            return AppendDateTime(*static_cast<const QDateTime*>(data), out);
+        case Kind::Other:
+            return false;
+    }
+    return false;
+}
+}  // namespace
+
+CellFormatter::CellFormatter(const QSqlRecord& record) {
+    columns_.reserve(record.count());
+    for (int i = 0, rec_count = record.count(); i < rec_count; ++i) {
+        const QMetaType type = record.field(i).metaType();
+        columns_.push_back({KindOf(type), type.id()});
+    }
+}
+
+void CellFormatter::AppendCell(int column, const QVariant& value, QString& out) const {
+    if (value.isNull()) {
+        return;
+    }
+    const bool known = column < static_cast<int>(columns_.size());
+    if (known && value.metaType().id() == columns_[column].type_id) {
+        const qsizetype size = out.size();
+        if (AppendTyped(columns_[column].kind, value, out)) {
+            return;
+        }
+        out.truncate(size);
+    }
+    AppendEscapedCSV(value.toString(), out);
+}
+
+void CellFormatter::AppendRow(const QSqlQuery& query, QString& out) const {
+    for (int i = 0, columns = static_cast<int>(columns_.size()); i < columns; ++i) {
+        if (i > 0) {
+            out.append(QLatin1Char(','));
+        }
+        AppendCell(i, query.value(i), out);
+    }
+    out.append(QLatin1Char('\n'));
+}
+
+CellFormatter::Kind CellFormatter::KindOf(QMetaType type) {
+    switch (type.id()) {
+        case QMetaType::QString:
+            return Kind::String;
+        case QMetaType::Bool:
+            return Kind::Bool;
+        case QMetaType::Short:
+        case QMetaType::Int:
+        case QMetaType::Long:
+        case QMetaType::LongLong:
+            return Kind::Int;
+        case QMetaType::UShort:
+        case QMetaType::UInt:
+        case QMetaType::ULong:
+        case QMetaType::ULongLong:
+            return Kind::UInt;
+        case QMetaType::Float:
+            return Kind::Float;
+        case QMetaType::Double:
+            return Kind::Double;
+        case QMetaType::QDate:
+            return Kind::Date;
+        case QMetaType::QTime:
+            return Kind::Time;
+        case QMetaType::QDateTime:
+            return Kind::DateTime;
+        default:
+            return Kind::Other;
+    }
+}
+}  // namespace outfit::utils::csv
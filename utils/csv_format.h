@@ -0,0 +1,53 @@
+#ifndef CREATIVE_CSV_FORMAT_H
+#define CREATIVE_CSV_FORMAT_H
+
+#include <QMetaType>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QString>
+#include <QVariant>
+#include <cstdint>
+#include <vector>
+
+namespace outfit::utils::csv {
+// Serializes query values into a CSV row without going through QVariant::toString().
+//
+// The column types are inspected once per query; integers, floating point numbers, booleans and
+// ISO dates/times are then written with std::to_chars-style routines straight into the row buffer.
+// A value whose type does not match its column (SQLite is dynamically typed) and any exotic type
+// falls back to toString(). NULL values are written as empty fields.
+class CellFormatter {
+   public:
+    enum class Kind : uint8_t {
+        String,
+        Bool,
+        Int,
+        UInt,
+        Float,
+        Double,
+        Date,
+        Time,
+        DateTime,
+        Other,
+    };
+
+    explicit CellFormatter(const QSqlRecord& record);
+
+    // Appends the escaped `value` of `column` to `out`.
+    void AppendCell(int column, const QVariant& value, QString& out) const;
+    // Appends the current row of `query`, including the line terminator, to `out`.
+    void AppendRow(const QSqlQuery& query, QString& out) const;
+
+    [[nodiscard]] static Kind KindOf(QMetaType type);
+
+   private:
+    struct Column {
+        Kind kind;
+        int type_id;
+    };
+
+    std::vector<Column> columns_;
+};
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_CSV_FORMAT_H
@@ -0,0 +1,50 @@
+#include "csv_format.h"
+
+#include <QLocale>
+#include <QMetaType>
+#include <QSqlField>
+#include <QSqlRecord>
+#include <QString>
+#include <QVariant>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <limits>
+
+namespace {
+using outfit::utils::csv::CellFormatter;
+
+template <class T>
+QString Format(T value) {
+    QSqlRecord record;
+    record.append(QSqlField("value", QMetaType::fromType<T>()));
+    QString out;
+    CellFormatter(record).AppendCell(0, QVariant::fromValue(value), out);
+    return out;
+}
+}  // namespace
+
+TEST_CASE("Doubles are formatted like QString::number with the shortest precision") {
+    using Limits = std::numeric_limits<double>;
+    const double values[] = {
+        0.0, -0.0, 1.0, -1.0, 0.1, 0.1 + 0.2, 1.0 / 3.0, 100.0, 12345.678,
+        // Around the switch between the fixed and the exponent form.
+        1e4, 1e5, 123456.0, 1e15, 1e16, 1e17, 123456789012345678.0, 1e21, 1.5e22,
+        1e-3, 1e-4, 1e-5, 0.00012345, 1.25e-7, -2.5e-10,
+        // Three-digit exponents and the ends of the range.
+        1e100, 1.5e300, -1e-300, Limits::max(), Limits::lowest(), Limits::min(),
+        Limits::denorm_min(), Limits::infinity(), -Limits::infinity(), Limits::quiet_NaN(),
+        -Limits::quiet_NaN()};
+    for (const double value : values) {
+        INFO(value);
+        CHECK(Format(value) == QString::number(value, 'g', QLocale::FloatingPointShortest));
+    }
+}
+
+TEST_CASE("Floats are formatted with the shortest digits of the float") {
+    CHECK(Format(0.1F) == "0.1");
+    CHECK(Format(-0.0F) == "-0");
+    CHECK(Format(16777216.0F) == "16777216");
+    CHECK(Format(1e20F) == "1e+20");
+    CHECK(Format(std::numeric_limits<float>::infinity()) == "inf");
+    CHECK(Format(std::nanf("")) == "nan");
+}
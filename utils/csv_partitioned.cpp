@@ -0,0 +1,235 @@
+#include "csv_partitioned.h"
+
+#include "csv_format.h"
+#include "csv_sink.h"
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QFile>
+#include <QLatin1Char>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace outfit::utils::csv {
+namespace {
+// Parts are copied into the output through a buffer of this size.
+constexpr qint64 kCopyBlockSize = qint64{1} << 20;
+
+struct Chunk {
+    // Temporary file the range is serialized into.
+    QString file_name;
+    QString error;
+    qint64 rows = 0;
+    bool done = false;
+};
+
+QString NextConnectionName() {
+    static std::atomic<quint64> counter = 0;
+    return QStringLiteral("outfit_csv_partition_%1").arg(counter.fetch_add(1));
+}
+
+// Serializes the rows of `range` from `database` into `chunk.file_name`. Returns the error, if any.
+QString WriteRange(
+    QSqlDatabase& database, const QString& sql, const KeyRange& range,
+    const std::atomic<bool>& failed, Chunk& chunk) {
+    if (!database.open()) {
+        return "failed to open database: " + database.lastError().text();
+    }
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    if (!query.prepare(sql)) {
+        return "failed to prepare query: " + query.lastError().text();
+    }
+    query.addBindValue(range.first);
+    query.addBindValue(range.last);
+    if (!query.exec()) {
+        return "failed to run query: " + query.lastError().text();
+    }
+    QFile part(chunk.file_name);
+    if (!part.open(QFile::WriteOnly | QFile::Unbuffered)) {
+        return "failed to open file: " + part.errorString();
+    }
+    CsvSink sink(&part);
+    const CellFormatter formatter(query.record());
+    QString row;
+    while (!failed.load(std::memory_order_relaxed) && query.next()) {
+        row.truncate(0);
+        formatter.AppendRow(query, row);
+        if (!sink.WriteRow(row)) {
+            return "failed to write file: " + sink.ErrorString();
+        }
+        ++chunk.rows;
+    }
+    if (query.lastError().isValid()) {
+        return "failed to fetch rows: " + query.lastError().text();
+    }
+    if (!sink.Flush()) {
+        return "failed to write file: " + sink.ErrorString();
+    }
+    return QString();
+}
+
+void ExportRange(
+    const QString& source_connection, const QString& sql, const KeyRange& range,
+    const std::atomic<bool>& failed, Chunk& chunk) {
+    const QString connection_name = NextConnectionName();
+    {
+        QSqlDatabase database = QSqlDatabase::cloneDatabase(source_connection, connection_name);
+        chunk.error = WriteRange(database, sql, range, failed, chunk);
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+}
+
+// Copies the part `file_name` into `sink` through `buffer` and removes it.
+bool AppendPart(const QString& file_name, CsvSink& sink, QByteArray& buffer, QString& error) {
+    QFile part(file_name);
+    if (!part.open(QFile::ReadOnly | QFile::Unbuffered)) {
+        error = "failed to open file: " + part.errorString();
+        return false;
+    }
+    qint64 size = 0;
+    while ((size = part.read(buffer.data(), buffer.size())) > 0) {
+        if (!sink.WriteEncoded(QByteArrayView(buffer.constData(), size))) {
+            error = "failed to write file: " + sink.ErrorString();
+            return false;
+        }
+    }
+    if (size < 0) {
+        error = "failed to read file: " + part.errorString();
+        return false;
+    }
+    part.remove();
+    return true;
+}
+}  // namespace
+
+std::vector<KeyRange> SplitKeyRange(qint64 min_key, qint64 max_key, int chunks) {
+    // Unsigned arithmetic keeps the full qint64 range from overflowing.
+    const quint64 span = static_cast<quint64>(max_key) - static_cast<quint64>(min_key);
+    const quint64 count =
+        std::min<quint64>(std::max(chunks, 1), span == UINT64_MAX ? span : span + 1);
+    const quint64 step = (span / count) + 1;
+    std::vector<KeyRange> ranges;
+    ranges.reserve(count);
+    for (quint64 i = 0, offset = 0; i < count; ++i, offset += step) {
+        const quint64 first = static_cast<quint64>(min_key) + offset;
+        const bool last_range = i + 1 == count || span - offset < step;
+        const quint64 last = last_range ? static_cast<quint64>(max_key) : first + step - 1;
+        ranges.push_back({static_cast<qint64>(first), static_cast<qint64>(last)});
+        if (last_range) {
+            break;
+        }
+    }
+    return ranges;
+}
+
+ExportResult ExportPartitioned(
+    const QSqlDatabase& database, const PartitionedQuery& partition, const QString& header,
+    const QString& file_name, int chunks) {
+    ExportResult result;
+    const QString filter =
+        partition.where.isEmpty() ? QString() : QStringLiteral(" WHERE (%1)").arg(partition.where);
+    QSqlQuery bounds(database);
+    if (!bounds.exec(QStringLiteral("SELECT MIN(%1), MAX(%1) FROM %2%3")
+                         .arg(partition.key_column, partition.table, filter)) ||
+        !bounds.next()) {
+        result.error = "failed to run query: " + bounds.lastError().text();
+        return result;
+    }
+    QFile csv_file(file_name);
+    if (!csv_file.open(QFile::WriteOnly | QFile::Unbuffered)) {
+        result.error = "failed to open file: " + csv_file.errorString();
+        return result;
+    }
+    CsvSink sink(&csv_file);
+    QString header_row = header;
+    header_row.append(QLatin1Char('\n'));
+    sink.WriteRow(header_row);
+    if (bounds.value(0).isNull()) {
+        // No rows match, only the header is written.
+        if (!sink.Flush()) {
+            result.error = "failed to write file: " + sink.ErrorString();
+        }
+        result.bytes = sink.BytesWritten();
+        return result;
+    }
+
+    const std::vector<KeyRange> ranges =
+        SplitKeyRange(bounds.value(0).toLongLong(), bounds.value(1).toLongLong(), chunks);
+    const QString sql = QStringLiteral("SELECT %1 FROM %2 WHERE %3%4 BETWEEN ? AND ? ORDER BY %4")
+                            .arg(
+                                partition.columns, partition.table,
+                                partition.where.isEmpty()
+                                    ? QString()
+                                    : QStringLiteral("(%1) AND ").arg(partition.where),
+                                partition.key_column);
+    const QString source_connection = database.connectionName();
+
+    // Next to the output, so the parts land on the same disk and are removed with the directory.
+    const QTemporaryDir parts_dir(file_name + ".parts-XXXXXX");
+    if (!parts_dir.isValid()) {
+        result.error = "failed to create directory: " + parts_dir.errorString();
+        csv_file.remove();
+        return result;
+    }
+    std::vector<Chunk> results(ranges.size());
+    for (size_t i = 0; i < results.size(); ++i) {
+        results[i].file_name = parts_dir.filePath(QString::number(i));
+    }
+    QMutex mutex;
+    QWaitCondition chunk_done;
+    std::atomic<bool> failed = false;
+    QThreadPool pool;
+    pool.setMaxThreadCount(static_cast<int>(ranges.size()));
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        pool.start([&, i] {
+            ExportRange(source_connection, sql, ranges[i], failed, results[i]);
+            if (!results[i].error.isEmpty()) {
+                // The export fails anyway, the other workers can stop.
+                failed = true;
+            }
+            const QMutexLocker locker(&mutex);
+            results[i].done = true;
+            chunk_done.wakeAll();
+        });
+    }
+
+    // Parts are appended in key order as soon as each one is complete, then removed.
+    QByteArray buffer(kCopyBlockSize, Qt::Uninitialized);
+    for (Chunk& chunk : results) {
+        {
+            QMutexLocker locker(&mutex);
+            while (!chunk.done) {
+                chunk_done.wait(&mutex);
+            }
+        }
+        if (!chunk.error.isEmpty()) {
+            result.error = chunk.error;
+            break;
+        }
+        if (!AppendPart(chunk.file_name, sink, buffer, result.error)) {
+            break;
+        }
+        result.rows += chunk.rows;
+    }
+    failed = !result.Ok();
+    pool.waitForDone();
+    const bool flushed = sink.Flush();
+    result.bytes = sink.BytesWritten();
+    if (failed || !flushed) {
+        if (result.Ok()) {
+            result.error = "failed to write file: " + sink.ErrorString();
+        }
+        csv_file.remove();
+    }
+    return result;
+}
+}  // namespace outfit::utils::csv
@@ -0,0 +1,48 @@
+#ifndef CREATIVE_CSV_PARTITIONED_H
+#define CREATIVE_CSV_PARTITIONED_H
+
+#include "csv_export.h"
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringLiteral>
+#include <QtGlobal>
+#include <vector>
+
+namespace outfit::utils::csv {
+// A query that can be split into disjoint ranges of an integer key.
+struct PartitionedQuery {
+    // Table, or parenthesized subquery with an alias, to export.
+    QString table;
+    // Integer column the ranges are split on, usually the primary key.
+    QString key_column;
+    // Select list of the exported columns.
+    QString columns = QStringLiteral("*");
+    // Optional filter applied to every range.
+    QString where;
+};
+
+// Inclusive range of key values.
+struct KeyRange {
+    qint64 first;
+    qint64 last;
+};
+
+// Splits [`min_key`, `max_key`] into at most `chunks` adjacent ranges of nearly equal width that
+// cover every key exactly once, in key order. Never returns more ranges than there are keys.
+std::vector<KeyRange> SplitKeyRange(qint64 min_key, qint64 max_key, int chunks);
+
+// Splits `partition` into `chunks` key ranges, serializes every range into its own temporary file
+// on a thread pool, each thread over its own clone of `database`, and stitches the files into
+// `file_name` in key order. Rows within a range are ordered by the key as well. The temporary
+// files live in a directory next to `file_name`, so memory use does not grow with the table.
+//
+// The first error of any worker fails the export and the output file is removed.
+//
+// Every worker opens a new connection, so `database` must not be an in-memory SQLite database.
+ExportResult ExportPartitioned(
+    const QSqlDatabase& database, const PartitionedQuery& partition, const QString& header,
+    const QString& file_name, int chunks);
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_CSV_PARTITIONED_H
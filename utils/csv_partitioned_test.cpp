@@ -0,0 +1,148 @@
+#include "csv_partitioned.h"
+
+#include "csv_export.h"
+#include "test_util.h"
+
+#include <QDir>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QStringList>
+#include <QVariant>
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <limits>
+#include <vector>
+
+namespace {
+using outfit::utils::csv::ExportPartitioned;
+using outfit::utils::csv::ExportQuery;
+using outfit::utils::csv::ExportResult;
+using outfit::utils::csv::KeyRange;
+using outfit::utils::csv::PartitionedQuery;
+using outfit::utils::csv::SplitKeyRange;
+using outfit::utils::testing::ReadFile;
+using outfit::utils::testing::TestApplication;
+
+constexpr auto kConnection = "csv_partitioned_test";
+
+// Every key of [min_key, max_key] is in exactly one range, and the ranges are in key order.
+void CheckCoversOnce(qint64 min_key, qint64 max_key, int chunks) {
+    const std::vector<KeyRange> ranges = SplitKeyRange(min_key, max_key, chunks);
+    REQUIRE_FALSE(ranges.empty());
+    CHECK(std::ssize(ranges) <= std::max(chunks, 1));
+    CHECK(ranges.front().first == min_key);
+    CHECK(ranges.back().last == max_key);
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        CHECK(ranges[i].first <= ranges[i].last);
+        if (i > 0) {
+            CHECK(ranges[i].first == ranges[i - 1].last + 1);
+        }
+    }
+}
+
+// Exports `ids` from a fresh table both in one query and through ExportPartitioned.
+void CheckPartitionedMatchesSingleQuery(const std::vector<qint64>& ids, int chunks) {
+    TestApplication();
+    const QTemporaryDir dir;
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", kConnection);
+        database.setDatabaseName(dir.filePath("test.sqlite"));
+        REQUIRE(database.open());
+        QSqlQuery insert(database);
+        REQUIRE(insert.exec("CREATE TABLE t (id INTEGER PRIMARY KEY, name TEXT)"));
+        REQUIRE(insert.prepare("INSERT INTO t (id, name) VALUES (?, ?)"));
+        for (const qint64 id : ids) {
+            insert.addBindValue(id);
+            insert.addBindValue(QString("row, %1").arg(id));
+            REQUIRE(insert.exec());
+        }
+
+        QSqlQuery query(database);
+        query.prepare("SELECT id, name FROM t ORDER BY id");
+        const ExportResult single = ExportQuery("id,name", query, dir.filePath("single.csv"));
+        REQUIRE(single.Ok());
+        const ExportResult partitioned = ExportPartitioned(
+            database, PartitionedQuery{"t", "id", "id, name", {}}, "id,name",
+            dir.filePath("partitioned.csv"), chunks);
+        REQUIRE(partitioned.Ok());
+        CHECK(partitioned.rows == std::ssize(ids));
+        CHECK(ReadFile(dir.filePath("partitioned.csv")) == ReadFile(dir.filePath("single.csv")));
+    }
+    QSqlDatabase::removeDatabase(kConnection);
+}
+}  // namespace
+
+TEST_CASE("SplitKeyRange covers widths that are not a multiple of the chunk count") {
+    CheckCoversOnce(0, 9, 4);
+    CheckCoversOnce(0, 10, 3);
+    CheckCoversOnce(1, 100, 7);
+    CheckCoversOnce(-5, 5, 3);
+    CheckCoversOnce(0, 5, 4);
+
+    const std::vector<KeyRange> ranges = SplitKeyRange(0, 10, 3);
+    REQUIRE(ranges.size() == 3);
+    CHECK(ranges[0].first == 0);
+    CHECK(ranges[0].last == 3);
+    CHECK(ranges[1].first == 4);
+    CHECK(ranges[1].last == 7);
+    CHECK(ranges[2].first == 8);
+    CHECK(ranges[2].last == 10);
+}
+
+TEST_CASE("SplitKeyRange returns one range when MIN == MAX") {
+    const std::vector<KeyRange> ranges = SplitKeyRange(42, 42, 8);
+    REQUIRE(ranges.size() == 1);
+    CHECK(ranges[0].first == 42);
+    CHECK(ranges[0].last == 42);
+}
+
+TEST_CASE("SplitKeyRange never returns more ranges than keys") {
+    CHECK(SplitKeyRange(0, 2, 8).size() == 3);
+    CheckCoversOnce(0, 2, 8);
+    CheckCoversOnce(7, 7, 0);
+}
+
+TEST_CASE("SplitKeyRange handles the full qint64 range") {
+    CheckCoversOnce(std::numeric_limits<qint64>::min(), std::numeric_limits<qint64>::max(), 4);
+    CheckCoversOnce(std::numeric_limits<qint64>::max() - 2, std::numeric_limits<qint64>::max(), 2);
+}
+
+TEST_CASE("ExportPartitioned writes the same file as a single query") {
+    SECTION("width not a multiple of the chunk count") {
+        std::vector<qint64> ids;
+        for (qint64 id = 1; id <= 103; ++id) {
+            ids.push_back(id);
+        }
+        CheckPartitionedMatchesSingleQuery(ids, 4);
+    }
+    SECTION("sparse keys") {
+        CheckPartitionedMatchesSingleQuery({-50, -1, 0, 3, 999, 1000}, 3);
+    }
+    SECTION("MIN == MAX") {
+        CheckPartitionedMatchesSingleQuery({7}, 4);
+    }
+}
+
+TEST_CASE("ExportPartitioned reports a failing worker and removes its output") {
+    TestApplication();
+    const QTemporaryDir dir;
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", kConnection);
+        database.setDatabaseName(dir.filePath("test.sqlite"));
+        REQUIRE(database.open());
+        QSqlQuery insert(database);
+        REQUIRE(insert.exec("CREATE TABLE t (id INTEGER PRIMARY KEY, name TEXT)"));
+        REQUIRE(insert.exec("INSERT INTO t (id, name) VALUES (1, 'a'), (2, 'b'), (3, 'c')"));
+
+        // The bounds query only reads the key, so only the workers see the unknown column.
+        const ExportResult result = ExportPartitioned(
+            database, PartitionedQuery{"t", "id", "id, missing", {}}, "id,missing",
+            dir.filePath("partitioned.csv"), 2);
+        CHECK_FALSE(result.Ok());
+        CHECK(result.error.contains("missing"));
+        CHECK(QDir(dir.path()).entryList(QDir::NoDotAndDotDot | QDir::AllEntries) ==
+              QStringList{"test.sqlite"});
+    }
+    QSqlDatabase::removeDatabase(kConnection);
+}
@@ -0,0 +1,229 @@
+#include "csv_reader.h"
+
+#include "bulk_inserter.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QLatin1String>
+#include <QStringList>
+#include <QVariant>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace outfit::utils::csv {
+namespace {
+// A field as it appears in the mapped file; quotes are stripped but not yet unescaped.
+struct Field {
+    const char* begin;
+    const char* end;
+    bool quoted;
+    bool escaped_quotes;
+};
+
+// Returns the first ',', '\n' or '\r' in [it, end), or end.
+const char* FindFieldEnd(const char* it, const char* end) {
+#if defined(__SSE2__)
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    for (; end - it >= 16; it += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+        const __m128i hits = _mm_or_si128(
+            _mm_cmpeq_epi8(chunk, comma),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, lf), _mm_cmpeq_epi8(chunk, cr)));
+        if (const int mask = _mm_movemask_epi8(hits); mask != 0) {
+            return it + std::countr_zero(static_cast<unsigned>(mask));
+        }
+    }
+#endif
+    for (; it != end; ++it) {
+        if (*it == ',' || *it == '\n' || *it == '\r') {
+            return it;
+        }
+    }
+    return end;
+}
+
+// Returns the first '"' in [it, end), or end. memchr is vectorized by every libc we ship on.
+const char* FindQuote(const char* it, const char* end) {
+    const void* quote = std::memchr(it, '"', end - it);
+    return quote != nullptr ? static_cast<const char*>(quote) : end;
+}
+
+// Splits RFC 4180 records without copying them.
+class RecordScanner {
+   public:
+    RecordScanner(const char* begin, const char* end) : it_(begin), end_(end) {
+    }
+
+    // Returns false once the input is exhausted.
+    // Check Malformed() after every record.
+    bool Next(std::vector<Field>& fields) {
+        if (it_ == end_) {
+            return false;
+        }
+        fields.clear();
+        while (true) {
+            fields.push_back(it_ != end_ && *it_ == '"' ? ScanQuoted() : ScanPlain());
+            if (it_ == end_) {
+                return true;
+            }
+            if (*it_ == ',') {
+                ++it_;
+                continue;
+            }
+            if (*it_ == '\r') {
+                ++it_;
+            }
+            if (it_ != end_ && *it_ == '\n') {
+                ++it_;
+            }
+            return true;
+        }
+    }
+
+    // What is wrong with the last record, or nullptr if nothing is: a quoted field that ran to the
+    // end of the input without its closing quote, or text between a closing quote and the
+    // delimiter.
+    [[nodiscard]] const char* Malformed() const {
+        return malformed_;
+    }
+
+   private:
+    Field ScanPlain() {
+        const char* const begin = it_;
+        it_ = FindFieldEnd(it_, end_);
+        return {begin, it_, false, false};
+    }
+
+    Field ScanQuoted() {
+        Field field{++it_, end_, true, false};
+        while (true) {
+            const char* const quote = FindQuote(it_, end_);
+            if (quote == end_) {
+                // The field would swallow the rest of the file; the caller reports it.
+                malformed_ = "an unterminated quote";
+                it_ = end_;
+                return field;
+            }
+            if (quote + 1 != end_ && quote[1] == '"') {
+                field.escaped_quotes = true;
+                it_ = quote + 2;
+                continue;
+            }
+            field.end = quote;
+            it_ = FindFieldEnd(quote + 1, end_);
+            if (it_ != quote + 1) {
+                malformed_ = "text after a closing quote";
+            }
+            return field;
+        }
+    }
+
+    const char* it_;
+    const char* end_;
+    const char* malformed_ = nullptr;
+};
+
+QString DecodeText(const Field& field) {
+    QString text = QString::fromUtf8(field.begin, field.end - field.begin);
+    if (field.escaped_quotes) {
+        text.replace(QStringLiteral("\"\""), QStringLiteral("\""));
+    }
+    return text;
+}
+
+QVariant DecodeValue(const Field& field) {
+    if (!field.quoted && field.begin == field.end) {
+        return QVariant(QMetaType::fromType<QString>());
+    }
+    return DecodeText(field);
+}
+
+// An empty line. Only skipped with several columns: with one it is a record with a NULL.
+bool IsBlank(const std::vector<Field>& fields) {
+    return fields.size() == 1 && !fields[0].quoted && fields[0].begin == fields[0].end;
+}
+
+bool LoadRecords(
+    QSqlDatabase& database, const QString& table, RecordScanner& scanner, QString& error) {
+    std::vector<Field> fields;
+    if (!scanner.Next(fields)) {
+        error = "file has no header";
+        return false;
+    }
+    if (scanner.Malformed() != nullptr) {
+        error = QStringLiteral("header has %1").arg(QLatin1String(scanner.Malformed()));
+        return false;
+    }
+    QStringList names;
+    for (const Field& field : fields) {
+        names.append(DecodeText(field));
+    }
+    const size_t column_count = names.size();
+    BulkInserter inserter(database, table, names);
+    for (qint64 record = 2; scanner.Next(fields); ++record) {
+        if (scanner.Malformed() != nullptr) {
+            error = QStringLiteral("record %1 has %2")
+                        .arg(record)
+                        .arg(QLatin1String(scanner.Malformed()));
+            return false;
+        }
+        if (column_count > 1 && IsBlank(fields)) {
+            continue;
+        }
+        if (fields.size() > column_count) {
+            error = QStringLiteral("record %1 has %2 fields, expected %3")
+                        .arg(record)
+                        .arg(fields.size())
+                        .arg(column_count);
+            return false;
+        }
+        for (const Field& field : fields) {
+            inserter.AddValue(DecodeValue(field));
+        }
+        if (!inserter.EndRow()) {
+            error = inserter.ErrorString();
+            return false;
+        }
+    }
+    if (!inserter.Finish()) {
+        error = inserter.ErrorString();
+        return false;
+    }
+    return true;
+}
+}  // namespace
+
+bool LoadCsv(
+    QSqlDatabase& database, const QString& table, const QString& file_name, QString& error) {
+    QFile file(file_name);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = "failed to open file";
+        return false;
+    }
+    qint64 size = file.size();
+    QByteArray contents;
+    const char* begin = nullptr;
+    if (const uchar* mapped = size > 0 ? file.map(0, size) : nullptr; mapped != nullptr) {
+        begin = reinterpret_cast<const char*>(mapped);
+    } else {
+        // Empty files cannot be mapped, neither can pipes and other special files.
+        contents = file.readAll();
+        begin = contents.constData();
+        size = contents.size();
+    }
+    const char* const end = begin + size;
+    if (end - begin >= 3 && std::memcmp(begin, "\xEF\xBB\xBF", 3) == 0) {
+        begin += 3;
+    }
+
+    RecordScanner scanner(begin, end);
+    return LoadRecords(database, table, scanner, error);
+}
+}  // namespace outfit::utils::csv
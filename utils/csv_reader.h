@@ -0,0 +1,21 @@
+#ifndef CREATIVE_CSV_READER_H
+#define CREATIVE_CSV_READER_H
+
+#include <QSqlDatabase>
+#include <QString>
+
+namespace outfit::utils::csv {
+// Loads the CSV file `file_name` into the existing table `table`.
+//
+// The first record names the target columns. The file is memory-mapped and split into records
+// in place with a vectorized scan; fields are only decoded when they are bound. Rows are inserted
+// by a BulkInserter inside a single transaction, which is rolled back on any error. Unquoted
+// empty fields are inserted as NULL, the inverse of SaveQuery(). Empty lines are skipped, except
+// with a single column, where an empty line is how SaveQuery() writes a NULL. A quoted field
+// without its closing quote, or with text between its closing quote and the delimiter, is an error
+// rather than a field that runs to the end of the file or silently loses that text.
+bool LoadCsv(
+    QSqlDatabase& database, const QString& table, const QString& file_name, QString& error);
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_CSV_READER_H
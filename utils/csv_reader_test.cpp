@@ -0,0 +1,152 @@
+#include "csv_reader.h"
+
+#include "test_util.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QTemporaryDir>
+#include <QVariant>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+namespace {
+using outfit::utils::csv::LoadCsv;
+using outfit::utils::testing::TestApplication;
+
+constexpr auto kConnection = "csv_reader_test";
+
+struct Row {
+    QVariant id;
+    QVariant name;
+    QVariant note;
+};
+
+// Loads `contents` into a fresh table t (id, name, note). Returns the rows in file order, or sets
+// `error` and returns whatever the table holds after the failed load.
+std::vector<Row> Load(const QByteArray& contents, bool& ok, QString& error) {
+    TestApplication();
+    const QTemporaryDir dir;
+    std::vector<Row> rows;
+    {
+        QFile file(dir.filePath("input.csv"));
+        REQUIRE(file.open(QFile::WriteOnly));
+        REQUIRE(file.write(contents) == contents.size());
+        file.close();
+
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", kConnection);
+        database.setDatabaseName(":memory:");
+        REQUIRE(database.open());
+        QSqlQuery query(database);
+        REQUIRE(query.exec("CREATE TABLE t (id INTEGER, name TEXT, note TEXT)"));
+        ok = LoadCsv(database, "t", file.fileName(), error);
+        REQUIRE(query.exec("SELECT id, name, note FROM t ORDER BY rowid"));
+        while (query.next()) {
+            rows.push_back({query.value(0), query.value(1), query.value(2)});
+        }
+    }
+    QSqlDatabase::removeDatabase(kConnection);
+    return rows;
+}
+
+std::vector<Row> Load(const QByteArray& contents) {
+    bool ok = false;
+    QString error;
+    std::vector<Row> rows = Load(contents, ok, error);
+    INFO(error.toStdString());
+    REQUIRE(ok);
+    return rows;
+}
+}  // namespace
+
+TEST_CASE("LoadCsv unescapes quoted fields with quotes, commas and newlines") {
+    const std::vector<Row> rows =
+        Load("id,name,note\n1,\"say \"\"hi\"\"\",\"a, b\"\n2,\"two\nlines\",plain\n");
+    REQUIRE(rows.size() == 2);
+    CHECK(rows[0].name.toString() == "say \"hi\"");
+    CHECK(rows[0].note.toString() == "a, b");
+    CHECK(rows[1].name.toString() == "two\nlines");
+    CHECK(rows[1].note.toString() == "plain");
+}
+
+TEST_CASE("LoadCsv accepts CRLF line breaks") {
+    const std::vector<Row> rows = Load("id,name,note\r\n1,a,b\r\n2,\"c\r\nd\",e\r\n");
+    REQUIRE(rows.size() == 2);
+    CHECK(rows[0].name.toString() == "a");
+    CHECK(rows[0].note.toString() == "b");
+    // Line breaks inside quotes are data and are kept as written.
+    CHECK(rows[1].name.toString() == "c\r\nd");
+    CHECK(rows[1].note.toString() == "e");
+}
+
+TEST_CASE("LoadCsv rejects an unterminated quote") {
+    bool ok = true;
+    QString error;
+    const std::vector<Row> rows = Load("id,name,note\n1,a,b\n2,\"open,c\n3,d,e\n", ok, error);
+    CHECK_FALSE(ok);
+    CHECK(error.contains("unterminated"));
+    CHECK(error.contains("record 3"));
+    // The rows before it are rolled back with the rest of the load.
+    CHECK(rows.empty());
+
+    Load("\"id,name,note\n1,a,b\n", ok, error);
+    CHECK_FALSE(ok);
+    CHECK(error.contains("header"));
+}
+
+TEST_CASE("LoadCsv rejects text after a closing quote") {
+    bool ok = true;
+    QString error;
+    Load("id,name,note\n1,\"ab\"cd,e\n", ok, error);
+    CHECK_FALSE(ok);
+    CHECK(error.contains("record 2"));
+    CHECK(error.contains("closing quote"));
+}
+
+TEST_CASE("LoadCsv skips empty lines, unless there is a single column") {
+    const std::vector<Row> rows = Load("id,name,note\n1,a,b\n\n2,c,d\r\n\r\n");
+    REQUIRE(rows.size() == 2);
+    CHECK(rows[1].id.toInt() == 2);
+
+    // With one column, SaveQuery() writes a NULL as an empty line.
+    const std::vector<Row> names = Load("name\nfirst\n\nthird\n");
+    REQUIRE(names.size() == 3);
+    CHECK(names[0].name.toString() == "first");
+    CHECK(names[1].name.isNull());
+    CHECK(names[2].name.toString() == "third");
+}
+
+TEST_CASE("LoadCsv reads a trailing empty field as NULL") {
+    const std::vector<Row> rows = Load("id,name,note\n1,a,\n2,b,\"\"");
+    REQUIRE(rows.size() == 2);
+    CHECK(rows[0].name.toString() == "a");
+    CHECK(rows[0].note.isNull());
+    // Quoting tells an empty string from NULL, also at the very end of the input.
+    CHECK_FALSE(rows[1].note.isNull());
+    CHECK(rows[1].note.toString().isEmpty());
+}
+
+TEST_CASE("LoadCsv skips a UTF-8 byte order mark") {
+    const std::vector<Row> rows = Load("\xEF\xBB\xBFid,name,note\n1,\xD0\xB0,b\n");
+    REQUIRE(rows.size() == 1);
+    CHECK(rows[0].id.toInt() == 1);
+    CHECK(rows[0].name.toString() == QString::fromUtf8("\xD0\xB0"));
+}
+
+TEST_CASE("LoadCsv reads an unquoted empty field as NULL") {
+    const std::vector<Row> rows = Load("id,name,note\n1,,\"\"\n");
+    REQUIRE(rows.size() == 1);
+    CHECK(rows[0].name.isNull());
+    CHECK_FALSE(rows[0].note.isNull());
+}
+
+TEST_CASE("LoadCsv finds delimiters past the first 16 bytes of a field") {
+    const QByteArray name(40, 'x');
+    const std::vector<Row> rows = Load("id,name,note\n1," + name + ",tail\r\n2,y,z");
+    REQUIRE(rows.size() == 2);
+    CHECK(rows[0].name.toString() == QString::fromLatin1(name));
+    CHECK(rows[0].note.toString() == "tail");
+    CHECK(rows[1].note.toString() == "z");
+}
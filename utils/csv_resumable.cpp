@@ -0,0 +1,247 @@
+#include "csv_resumable.h"
+
+#include "csv_escape.h"
+#include "csv_format.h"
+#include "csv_sink.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QLatin1Char>
+#include <QMetaType>
+#include <QSaveFile>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QStringList>
+#include <QStringLiteral>
+#include <QVariant>
+#include <algorithm>
+#include <optional>
+
+namespace outfit::utils::csv {
+namespace {
+struct Checkpoint {
+    // SQL of the whole export; a checkpoint of a different query is ignored.
+    QString query;
+    // Header and target of the export; only the same ones resume it.
+    QString header;
+    bool header_from_columns = false;
+    QString file;
+    // Key the export started after, null for a full export.
+    QVariant since;
+    // Key of the last row in the file, null if no row was written yet.
+    QVariant last_key;
+    // File size after the row with `last_key`.
+    qint64 offset = 0;
+    qint64 rows = 0;
+    bool complete = false;
+};
+
+// Keys keep their type so that they bind the same way after a restart; the value is stored as a
+// string because JSON numbers cannot hold every 64-bit integer.
+QJsonValue KeyToJson(const QVariant& key) {
+    if (key.isNull()) {
+        return QJsonValue::Null;
+    }
+    return QJsonObject{
+        {"type", QString::fromLatin1(key.metaType().name())},
+        {"value", key.toString()},
+    };
+}
+
+QVariant KeyFromJson(const QJsonValue& json) {
+    if (!json.isObject()) {
+        return {};
+    }
+    const QJsonObject object = json.toObject();
+    QVariant key = object["value"].toString();
+    key.convert(QMetaType::fromName(object["type"].toString().toLatin1()));
+    return key;
+}
+
+bool LoadCheckpoint(const QString& path, Checkpoint& checkpoint) {
+    QFile file(path);
+    if (!file.open(QFile::ReadOnly)) {
+        return false;
+    }
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll());
+    if (!document.isObject()) {
+        return false;
+    }
+    const QJsonObject object = document.object();
+    checkpoint.query = object["query"].toString();
+    checkpoint.header = object["header"].toString();
+    checkpoint.header_from_columns = object["header_from_columns"].toBool();
+    checkpoint.file = object["file"].toString();
+    checkpoint.since = KeyFromJson(object["since"]);
+    checkpoint.last_key = KeyFromJson(object["last_key"]);
+    checkpoint.offset = object["offset"].toInteger();
+    checkpoint.rows = object["rows"].toInteger();
+    checkpoint.complete = object["complete"].toBool();
+    return true;
+}
+
+// Replaces the checkpoint atomically, so a crash leaves either the old or the new one.
+bool SaveCheckpoint(const QString& path, const Checkpoint& checkpoint, QString& error) {
+    const QJsonObject object{
+        {"query", checkpoint.query},
+        {"header", checkpoint.header},
+        {"header_from_columns", checkpoint.header_from_columns},
+        {"file", checkpoint.file},
+        {"since", KeyToJson(checkpoint.since)},
+        {"last_key", KeyToJson(checkpoint.last_key)},
+        {"offset", checkpoint.offset},
+        {"rows", checkpoint.rows},
+        {"complete", checkpoint.complete},
+    };
+    QSaveFile file(path);
+    if (!file.open(QFile::WriteOnly) || file.write(QJsonDocument(object).toJson()) < 0 ||
+        !file.commit()) {
+        error = "failed to write checkpoint: " + file.errorString();
+        return false;
+    }
+    return true;
+}
+
+// One page of `query` after `after_key`, with the key appended as the last column.
+QString PageSql(const PartitionedQuery& query, int page_rows, bool after_key) {
+    QStringList conditions;
+    if (!query.where.isEmpty()) {
+        conditions.append(QStringLiteral("(%1)").arg(query.where));
+    }
+    if (after_key) {
+        conditions.append(QStringLiteral("%1 > ?").arg(query.key_column));
+    }
+    return QStringLiteral("SELECT %1, %2 FROM %3%4 ORDER BY %2 LIMIT %5")
+        .arg(
+            query.columns, query.key_column, query.table,
+            conditions.isEmpty() ? QString() : " WHERE " + conditions.join(" AND "))
+        .arg(page_rows);
+}
+}  // namespace
+
+ExportResult ExportResumable(
+    const QSqlDatabase& database, const PartitionedQuery& query, const QString& header,
+    const QString& file_name, const ResumableOptions& options) {
+    ExportResult result;
+    const int page_rows = std::max(options.page_rows, 1);
+    const QString checkpoint_file = options.checkpoint_file.isEmpty()
+                                        ? file_name + ".checkpoint"
+                                        : options.checkpoint_file;
+
+    Checkpoint checkpoint;
+    checkpoint.query = QStringLiteral("SELECT %1 FROM %2%3 ORDER BY %4")
+                           .arg(
+                               query.columns, query.table,
+                               query.where.isEmpty() ? QString() : " WHERE " + query.where,
+                               query.key_column);
+    checkpoint.header = options.header_from_columns ? QString() : header;
+    checkpoint.header_from_columns = options.header_from_columns;
+    checkpoint.file = file_name;
+    Checkpoint previous;
+    const bool have_previous =
+        LoadCheckpoint(checkpoint_file, previous) && previous.query == checkpoint.query;
+
+    // The file already starts with the previous export's header, and its offset only means
+    // something in the file it was recorded for.
+    QFile csv_file(file_name);
+    const bool resume = have_previous && !previous.complete &&
+                        previous.header == checkpoint.header &&
+                        previous.header_from_columns == checkpoint.header_from_columns &&
+                        previous.file == checkpoint.file && csv_file.exists() &&
+                        csv_file.size() >= previous.offset;
+    if (resume) {
+        checkpoint = previous;
+    } else if (have_previous && options.incremental) {
+        // An interrupted incremental export into another file still has to cover its delta.
+        checkpoint.since = previous.complete ? previous.last_key : previous.since;
+        checkpoint.last_key = checkpoint.since;
+    }
+
+    const QFile::OpenMode mode =
+        resume ? QFile::OpenMode(QFile::ReadWrite) : QFile::WriteOnly | QFile::Truncate;
+    if (!csv_file.open(mode | QFile::Unbuffered)) {
+        result.error = "failed to open file: " + csv_file.errorString();
+        return result;
+    }
+    const qint64 base_offset = resume ? checkpoint.offset : 0;
+    if (resume && (!csv_file.resize(base_offset) || !csv_file.seek(base_offset))) {
+        result.error = "failed to truncate file: " + csv_file.errorString();
+        return result;
+    }
+
+    CsvSink sink(&csv_file);
+    std::optional<CellFormatter> formatter;
+    bool header_pending = !resume;
+    QString row;
+    while (true) {
+        QSqlQuery page(database);
+        page.setForwardOnly(true);
+        page.prepare(PageSql(query, page_rows, !checkpoint.last_key.isNull()));
+        if (!checkpoint.last_key.isNull()) {
+            page.addBindValue(checkpoint.last_key);
+        }
+        if (!page.exec()) {
+            result.error = "failed to run query: " + page.lastError().text();
+            return result;
+        }
+        const QSqlRecord record = page.record();
+        const int columns = record.count() - 1;
+        if (!formatter) {
+            formatter.emplace(record);
+        }
+        if (header_pending) {
+            if (!options.header_from_columns) {
+                row = header;
+            } else {
+                row.truncate(0);
+                for (int i = 0; i < columns; ++i) {
+                    if (i > 0) {
+                        row.append(QLatin1Char(','));
+                    }
+                    AppendEscapedCSV(record.fieldName(i), row);
+                }
+            }
+            row.append(QLatin1Char('\n'));
+            sink.WriteRow(row);
+            header_pending = false;
+        }
+
+        qint64 fetched = 0;
+        QVariant last_key;
+        while (page.next()) {
+            row.truncate(0);
+            for (int i = 0; i < columns; ++i) {
+                if (i > 0) {
+                    row.append(QLatin1Char(','));
+                }
+                formatter->AppendCell(i, page.value(i), row);
+            }
+            row.append(QLatin1Char('\n'));
+            if (!sink.WriteRow(row)) {
+                break;
+            }
+            last_key = page.value(columns);
+            ++fetched;
+        }
+        // The checkpoint must never point past data that has not reached the file.
+        if (!sink.Flush()) {
+            result.error = "failed to write file: " + sink.ErrorString();
+            return result;
+        }
+        result.rows += fetched;
+        result.bytes = sink.BytesWritten();
+        if (fetched > 0) {
+            checkpoint.last_key = last_key;
+        }
+        checkpoint.rows += fetched;
+        checkpoint.offset = base_offset + sink.BytesWritten();
+        checkpoint.complete = fetched < page_rows;
+        if (!SaveCheckpoint(checkpoint_file, checkpoint, result.error) || checkpoint.complete) {
+            return result;
+        }
+    }
+}
+}  // namespace outfit::utils::csv
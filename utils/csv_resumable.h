@@ -0,0 +1,40 @@
+#ifndef CREATIVE_CSV_RESUMABLE_H
+#define CREATIVE_CSV_RESUMABLE_H
+
+#include "csv_export.h"
+#include "csv_partitioned.h"
+
+#include <QSqlDatabase>
+#include <QString>
+
+namespace outfit::utils::csv {
+struct ResumableOptions {
+    // Rows fetched per keyset page. A checkpoint is written after every page.
+    int page_rows = 10'000;
+    // JSON checkpoint file; `file_name` + ".checkpoint" when empty.
+    QString checkpoint_file;
+    // Exports only the rows whose key is greater than the last key of the previous completed
+    // export recorded in the checkpoint. Use one checkpoint file across runs for this.
+    bool incremental = false;
+    // Writes the column names of the result as the header instead of `header`, like
+    // CsvExportJob::SetHeaderFromColumns().
+    bool header_from_columns = false;
+};
+
+// Exports `query` page by page in key order, each page starting after the last key of the
+// previous one (keyset pagination), so no page gets slower the further the export is.
+//
+// After every page the file is flushed and the checkpoint records the last key, the file size and
+// the row count. If the checkpoint belongs to an unfinished export of the same query with the same
+// header into `file_name`, the file is truncated to the recorded size and the export continues after the
+// recorded key; otherwise the file is rewritten. The file and the checkpoint are left in place on
+// failure so the next call can resume.
+//
+// The key column must be unique and ordered, e.g. an increasing primary key or insertion
+// sequence; for the incremental mode it must also grow monotonically with new rows.
+ExportResult ExportResumable(
+    const QSqlDatabase& database, const PartitionedQuery& query, const QString& header,
+    const QString& file_name, const ResumableOptions& options = {});
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_CSV_RESUMABLE_H
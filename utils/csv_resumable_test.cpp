@@ -0,0 +1,126 @@
+#include "csv_resumable.h"
+
+#include "test_util.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QVariant>
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+using outfit::utils::csv::ExportResult;
+using outfit::utils::csv::ExportResumable;
+using outfit::utils::csv::PartitionedQuery;
+using outfit::utils::csv::ResumableOptions;
+using outfit::utils::testing::ReadFile;
+using outfit::utils::testing::TestApplication;
+
+constexpr auto kConnection = "csv_resumable_test";
+constexpr int kRows = 350;
+
+const PartitionedQuery kQuery{"t", "id", "id, name, price", {}};
+
+// Rewrites the checkpoint as it was before its export saw the last page.
+void MarkIncomplete(const QString& checkpoint_file) {
+    QJsonObject checkpoint = QJsonDocument::fromJson(ReadFile(checkpoint_file)).object();
+    REQUIRE(checkpoint["complete"].toBool());
+    checkpoint["complete"] = false;
+    QFile file(checkpoint_file);
+    REQUIRE(file.open(QFile::WriteOnly | QFile::Truncate));
+    REQUIRE(file.write(QJsonDocument(checkpoint).toJson()) > 0);
+}
+
+// Leaves `file_name` and its checkpoint as an export that stopped right after checkpointing row
+// 250 does.
+void ExportFirstRows(
+    QSqlDatabase& database, const QString& file_name, const ResumableOptions& options) {
+    REQUIRE(database.transaction());
+    QSqlQuery query(database);
+    REQUIRE(query.exec("DELETE FROM t WHERE id > 250"));
+    const ExportResult partial = ExportResumable(database, kQuery, QString(), file_name, options);
+    REQUIRE(database.rollback());
+    REQUIRE(partial.Ok());
+    REQUIRE(partial.rows == 250);
+    MarkIncomplete(file_name + ".checkpoint");
+}
+}  // namespace
+
+TEST_CASE("ExportResumable continues an export interrupted mid-page byte for byte") {
+    TestApplication();
+    const QTemporaryDir dir;
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", kConnection);
+        database.setDatabaseName(":memory:");
+        REQUIRE(database.open());
+        QSqlQuery query(database);
+        REQUIRE(query.exec("CREATE TABLE t (id INTEGER PRIMARY KEY, name TEXT, price REAL)"));
+        REQUIRE(query.prepare("INSERT INTO t (id, name, price) VALUES (?, ?, ?)"));
+        for (int id = 1; id <= kRows; ++id) {
+            query.addBindValue(id);
+            query.addBindValue(QString("item \"%1\", size %2").arg(id).arg(id % 4));
+            query.addBindValue(id % 9 == 0 ? QVariant() : QVariant(id * 1.25));
+            REQUIRE(query.exec());
+        }
+
+        ResumableOptions options;
+        options.page_rows = 100;
+        options.header_from_columns = true;
+        const ExportResult full = ExportResumable(
+            database, kQuery, QString(), dir.filePath("reference.csv"), options);
+        REQUIRE(full.Ok());
+        CHECK(full.rows == kRows);
+        const QByteArray reference = ReadFile(dir.filePath("reference.csv"));
+
+        const QString file_name = dir.filePath("resumed.csv");
+        ExportFirstRows(database, file_name, options);
+
+        // The interrupted run had already written part of the next page past the checkpoint.
+        const QByteArray written = ReadFile(file_name);
+        REQUIRE(reference.startsWith(written));
+        QFile file(file_name);
+        REQUIRE(file.open(QFile::Append));
+        REQUIRE(file.write(reference.mid(written.size(), 57)) == 57);
+        file.close();
+
+        const ExportResult resumed =
+            ExportResumable(database, kQuery, QString(), file_name, options);
+        REQUIRE(resumed.Ok());
+        CHECK(resumed.rows == kRows - 250);
+        CHECK(ReadFile(file_name) == reference);
+
+        // A finished export starts over instead of resuming.
+        const ExportResult again =
+            ExportResumable(database, kQuery, QString(), file_name, options);
+        REQUIRE(again.Ok());
+        CHECK(again.rows == kRows);
+        CHECK(ReadFile(file_name) == reference);
+
+        // Resuming with another header would leave the old one in the file, so it starts over.
+        ExportFirstRows(database, file_name, options);
+        ResumableOptions explicit_header = options;
+        explicit_header.header_from_columns = false;
+        const ExportResult other_header =
+            ExportResumable(database, kQuery, "ID,NAME,PRICE", file_name, explicit_header);
+        REQUIRE(other_header.Ok());
+        CHECK(other_header.rows == kRows);
+        const QByteArray renamed = ReadFile(file_name);
+        CHECK(renamed.startsWith("ID,NAME,PRICE\n"));
+        CHECK(renamed.mid(renamed.indexOf('\n')) == reference.mid(reference.indexOf('\n')));
+
+        // So does an export into another file that shares the checkpoint.
+        ExportFirstRows(database, file_name, options);
+        ResumableOptions shared = options;
+        shared.checkpoint_file = file_name + ".checkpoint";
+        const ExportResult other_file =
+            ExportResumable(database, kQuery, QString(), dir.filePath("other.csv"), shared);
+        REQUIRE(other_file.Ok());
+        CHECK(other_file.rows == kRows);
+        CHECK(ReadFile(dir.filePath("other.csv")) == reference);
+    }
+    QSqlDatabase::removeDatabase(kConnection);
+}
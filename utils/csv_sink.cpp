@@ -0,0 +1,95 @@
+#include "csv_sink.h"
+
+#include <QFileDevice>
+#include <algorithm>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace outfit::utils::csv {
+CsvSink::CsvSink(QIODevice* device, CsvSinkOptions options)
+    : device_(device)
+    , options_(options)
+    , block_(std::max<qsizetype>(options.block_size, 4096), Qt::Uninitialized) {
+    timer_.start();
+}
+
+CsvSink::~CsvSink() {
+    Flush();
+}
+
+bool CsvSink::WriteRow(QStringView row) {
+    const qsizetype required = encoder_.requiredSpace(row.size());
+    if (required > block_.size() - used_ && !Flush()) {
+        return false;
+    }
+    if (required > block_.size()) {
+        // A single row larger than a whole block bypasses the block buffer.
+        const QByteArray encoded = encoder_.encode(row);
+        return WriteBlock(encoded.constData(), encoded.size());
+    }
+    char* const begin = block_.data() + used_;
+    used_ += encoder_.appendToBuffer(begin, row) - begin;
+    return true;
+}
+
+bool CsvSink::WriteEncoded(QByteArrayView rows) {
+    if (rows.size() > block_.size() - used_ && !Flush()) {
+        return false;
+    }
+    if (rows.size() > block_.size()) {
+        return WriteBlock(rows.data(), rows.size());
+    }
+    std::copy(rows.begin(), rows.end(), block_.data() + used_);
+    used_ += rows.size();
+    return true;
+}
+
+bool CsvSink::Flush() {
+    if (used_ == 0) {
+        return error_.isEmpty();
+    }
+    const bool ok = WriteBlock(block_.constData(), used_);
+    used_ = 0;
+    return ok;
+}
+
+qint64 CsvSink::BytesWritten() const {
+    return bytes_written_;
+}
+
+double CsvSink::BytesPerSecond() const {
+    const qint64 elapsed_ns = timer_.nsecsElapsed();
+    if (elapsed_ns <= 0) {
+        return 0.0;
+    }
+    return static_cast<double>(bytes_written_) * 1e9 / static_cast<double>(elapsed_ns);
+}
+
+QString CsvSink::ErrorString() const {
+    return error_;
+}
+
+bool CsvSink::WriteBlock(const char* data, qsizetype size) {
+    if (!error_.isEmpty()) {
+        return false;
+    }
+    if (device_->write(data, size) != size) {
+        error_ = device_->errorString();
+        return false;
+    }
+    bytes_written_ += size;
+#ifdef __linux__
+    if (options_.direct) {
+        if (auto* file = qobject_cast<QFileDevice*>(device_); file != nullptr && file->flush()) {
+            if (const int fd = file->handle(); fd >= 0 && ::fdatasync(fd) == 0) {
+                ::posix_fadvise(fd, file->pos() - size, size, POSIX_FADV_DONTNEED);
+            }
+        }
+    }
+#endif
+    return true;
+}
+}  // namespace outfit::utils::csv
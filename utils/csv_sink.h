@@ -0,0 +1,62 @@
+#ifndef CREATIVE_CSV_SINK_H
+#define CREATIVE_CSV_SINK_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QElapsedTimer>
+#include <QIODevice>
+#include <QString>
+#include <QStringEncoder>
+#include <QStringView>
+
+namespace outfit::utils::csv {
+struct CsvSinkOptions {
+    // Encoded rows are collected into blocks of this size before they reach the device.
+    qsizetype block_size = qsizetype{1} << 20;
+    // Forces every block to disk and drops it from the page cache, the closest QFile gets to
+    // O_DIRECT. Only has an effect for file devices on Linux.
+    bool direct = false;
+};
+
+// Buffered UTF-8 writer for CSV output.
+//
+// Each row is handed over as a complete UTF-16 string and converted in one pass straight into
+// the current block, which is written to the device once it is full. Open files with
+// QIODevice::Unbuffered so blocks are not copied again by QFile.
+class CsvSink {
+   public:
+    explicit CsvSink(QIODevice* device, CsvSinkOptions options = {});
+    ~CsvSink();
+
+    CsvSink(const CsvSink&) = delete;
+    CsvSink& operator=(const CsvSink&) = delete;
+    CsvSink(CsvSink&&) = delete;
+    CsvSink& operator=(CsvSink&&) = delete;
+
+    // `row` must include its line terminator.
+    bool WriteRow(QStringView row);
+    // Writes already UTF-8 encoded rows, e.g. a chunk serialized by another sink.
+    bool WriteEncoded(QByteArrayView rows);
+    bool Flush();
+
+    // Bytes handed to the device so far.
+    [[nodiscard]] qint64 BytesWritten() const;
+    // Write throughput since construction.
+    [[nodiscard]] double BytesPerSecond() const;
+    [[nodiscard]] QString ErrorString() const;
+
+   private:
+    bool WriteBlock(const char* data, qsizetype size);
+
+    QIODevice* device_;
+    CsvSinkOptions options_;
+    QStringEncoder encoder_{QStringEncoder::Utf8};
+    QByteArray block_;
+    qsizetype used_ = 0;
+    qint64 bytes_written_ = 0;
+    QElapsedTimer timer_;
+    QString error_;
+};
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_CSV_SINK_H
@@ -0,0 +1,26 @@
+#ifndef CREATIVE_TEST_UTIL_H
+#define CREATIVE_TEST_UTIL_H
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QFile>
+#include <QString>
+
+namespace outfit::utils::testing {
+// Qt SQL drivers are plugins, found only once an application object exists. Catch2 owns main(), so
+// tests that touch a database call this first.
+inline QCoreApplication& TestApplication() {
+    static int argc = 1;
+    static char name[] = "test";
+    static char* argv[] = {name, nullptr};
+    static QCoreApplication app(argc, argv);
+    return app;
+}
+
+inline QByteArray ReadFile(const QString& file_name) {
+    QFile file(file_name);
+    return file.open(QFile::ReadOnly) ? file.readAll() : QByteArray();
+}
+}  // namespace outfit::utils::testing
+
+#endif  // CREATIVE_TEST_UTIL_H